@@ -0,0 +1,309 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mining.h"
+#include "stratum_api.h"
+#include "sv2_protocol.h"
+#include "utils.h"
+#include "payloads.h"
+
+#define DEFAULT_ITERATIONS 20000
+#define BENCH_STACK_SIZE (256 * 1024)
+#define STACK_PAINT 0xA5
+#define VERSION_MASK 0x1fffe000
+#define POOL_DIFFICULTY 1000.0
+
+// Allocation counting: the build wraps malloc/calloc/realloc for the linked
+// stratum sources (-Wl,--wrap=...), only counted while a timed loop runs.
+#ifdef BENCH_WRAP_ALLOC
+static volatile bool counting_allocs;
+static long alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    if (counting_allocs) __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    if (counting_allocs) __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (counting_allocs) __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+typedef enum
+{
+    PATH_V1,
+    PATH_SV2,
+    PATH_SV2_EXT,
+} job_path;
+
+static const char *path_names[] = { "v1", "sv2", "sv2-ext" };
+
+// Everything decoded once per notify, as create_jobs_task does before building jobs
+typedef struct
+{
+    char name[32];
+    mining_notify notify;
+    coinbase_template v1_coinbase;
+    coinbase_template ext_coinbase;
+    sv2_ext_job_t *ext_job;
+    uint8_t prev_hash[32];
+    uint8_t merkle_root[32];
+} bench_case;
+
+typedef struct
+{
+    job_path path;
+    bench_case *c;
+    long iterations;
+    uint64_t elapsed_ns;
+    long allocs;
+} bench_run;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint8_t *hex_dup(const char *hex, size_t extra, size_t *len_out)
+{
+    size_t len = strlen(hex) / 2;
+    uint8_t *bin = calloc(1, len + extra + 1);
+    hex2bin(hex, bin, len);
+    *len_out = len + extra;
+    return bin;
+}
+
+// Encode a NewExtendedMiningJob payload carrying the notify's coinbase and merkle path
+static size_t encode_ext_job(const mining_notify *n, uint8_t *out)
+{
+    size_t pos = 0;
+    uint32_t u32;
+
+    u32 = 1;              memcpy(out + pos, &u32, 4); pos += 4; // channel_id
+    u32 = 42;             memcpy(out + pos, &u32, 4); pos += 4; // job_id
+    out[pos++] = 0x01;                                          // min_ntime present
+    memcpy(out + pos, &n->ntime, 4); pos += 4;
+    memcpy(out + pos, &n->version, 4); pos += 4;
+    out[pos++] = 1;                                             // version_rolling_allowed
+    out[pos++] = (uint8_t)n->n_merkle_branches;
+    memcpy(out + pos, n->merkle_branches, n->n_merkle_branches * 32);
+    pos += n->n_merkle_branches * 32;
+
+    uint16_t u16 = (uint16_t)n->coinbase_1_len;
+    memcpy(out + pos, &u16, 2); pos += 2;
+    memcpy(out + pos, n->coinbase_1_bin, n->coinbase_1_len); pos += n->coinbase_1_len;
+    u16 = (uint16_t)n->coinbase_2_len;
+    memcpy(out + pos, &u16, 2); pos += 2;
+    memcpy(out + pos, n->coinbase_2_bin, n->coinbase_2_len); pos += n->coinbase_2_len;
+    return pos;
+}
+
+static bool bench_case_init(bench_case *c, const bench_notify *src, size_t extra_coinbase_bytes, int n_branches)
+{
+    memset(c, 0, sizeof(*c));
+    snprintf(c->name, sizeof(c->name), "%s", src->name);
+
+    mining_notify *n = &c->notify;
+    n->job_id = (char *)src->job_id;
+    n->prev_block_hash = (char *)src->prev_block_hash;
+    decode_prev_block_hash(n->prev_block_hash, n->prev_block_hash_header, n->prev_block_hash_asic);
+    n->coinbase_1_bin = hex_dup(src->coinbase_1, 0, &n->coinbase_1_len);
+    n->coinbase_2_bin = hex_dup(src->coinbase_2, extra_coinbase_bytes, &n->coinbase_2_len);
+    n->n_merkle_branches = n_branches;
+    n->merkle_branches = malloc(32 * (n_branches ? n_branches : 1));
+    for (int i = 0; i < n_branches; i++) {
+        hex2bin(src->merkle_branches[i % src->n_merkle_branches], n->merkle_branches + 32 * i, 32);
+    }
+    n->version = src->version;
+    n->target = src->nbits;
+    n->ntime = src->ntime;
+
+    uint8_t extranonce_1[32];
+    size_t extranonce_1_len = strlen(src->extranonce_1) / 2;
+    hex2bin(src->extranonce_1, extranonce_1, extranonce_1_len);
+
+    if (!coinbase_template_init(&c->v1_coinbase, n->coinbase_1_bin, n->coinbase_1_len,
+                                extranonce_1, extranonce_1_len, src->extranonce_2_len,
+                                n->coinbase_2_bin, n->coinbase_2_len)) {
+        return false;
+    }
+
+    uint8_t *payload = malloc(64 + 32 * n_branches + n->coinbase_1_len + n->coinbase_2_len);
+    size_t payload_len = encode_ext_job(n, payload);
+    c->ext_job = sv2_parse_new_extended_mining_job(payload, payload_len, NULL);
+    free(payload);
+    if (!c->ext_job) return false;
+
+    // prev_hash and nbits arrive separately in SetNewPrevHash
+    hex2bin(src->prev_block_hash, c->ext_job->prev_hash, 32);
+    c->ext_job->nbits = src->nbits;
+    if (!coinbase_template_init(&c->ext_coinbase, c->ext_job->coinbase_prefix, c->ext_job->coinbase_prefix_len,
+                                extranonce_1, extranonce_1_len, src->extranonce_2_len,
+                                c->ext_job->coinbase_suffix, c->ext_job->coinbase_suffix_len)) {
+        return false;
+    }
+
+    // Standard channels get the merkle root from the pool; use the V1 one
+    uint8_t extranonce_2[32] = { 0 };
+    uint8_t coinbase_tx_hash[32];
+    calculate_coinbase_tx_hash_template(&c->v1_coinbase, extranonce_2, coinbase_tx_hash);
+    calculate_merkle_root_hash(coinbase_tx_hash, (uint8_t(*)[32])n->merkle_branches, n_branches, c->merkle_root);
+    memcpy(c->prev_hash, c->ext_job->prev_hash, 32);
+    return true;
+}
+
+static void bench_case_free(bench_case *c)
+{
+    free(c->notify.coinbase_1_bin);
+    free(c->notify.coinbase_2_bin);
+    free(c->notify.merkle_branches);
+    coinbase_template_free(&c->v1_coinbase);
+    coinbase_template_free(&c->ext_coinbase);
+    sv2_ext_job_free(c->ext_job);
+}
+
+static void *bench_thread(void *arg)
+{
+    bench_run *run = arg;
+    bench_case *c = run->c;
+    bm_job job;
+
+#ifdef BENCH_WRAP_ALLOC
+    alloc_count = 0;
+    counting_allocs = true;
+#endif
+    uint64_t start = now_ns();
+    for (long i = 0; i < run->iterations; i++) {
+        switch (run->path) {
+        case PATH_V1:
+            construct_bm_job_v1(&c->notify, &c->v1_coinbase, i, VERSION_MASK, POOL_DIFFICULTY, &job);
+            break;
+        case PATH_SV2:
+            construct_bm_job_sv2(i, c->notify.version, c->merkle_root, c->prev_hash, c->notify.ntime,
+                                 c->notify.target, VERSION_MASK, POOL_DIFFICULTY, &job);
+            break;
+        case PATH_SV2_EXT:
+            construct_bm_job_sv2_ext(c->ext_job->job_id, c->ext_job->version, c->ext_job->prev_hash,
+                                     c->ext_job->ntime, c->ext_job->nbits,
+                                     (const uint8_t(*)[32])c->ext_job->merkle_path, c->ext_job->merkle_path_count,
+                                     &c->ext_coinbase, i, VERSION_MASK, POOL_DIFFICULTY, &job);
+            break;
+        }
+        // Keep the job observable so the build cannot be optimised away
+        __asm__ volatile("" : : "r"(&job) : "memory");
+    }
+    run->elapsed_ns = now_ns() - start;
+#ifdef BENCH_WRAP_ALLOC
+    counting_allocs = false;
+    run->allocs = alloc_count;
+#endif
+    return NULL;
+}
+
+static void *idle_thread(void *arg)
+{
+    (void)arg;
+    return NULL;
+}
+
+// Run fn on a painted stack and return how many bytes of it were touched
+static size_t run_on_painted_stack(void *(*fn)(void *), void *arg)
+{
+    uint8_t *stack = aligned_alloc(4096, BENCH_STACK_SIZE);
+    memset(stack, STACK_PAINT, BENCH_STACK_SIZE);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, BENCH_STACK_SIZE);
+
+    pthread_t thread;
+    pthread_create(&thread, &attr, fn, arg);
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    // The stack grows down from the top of the buffer
+    size_t untouched = 0;
+    while (untouched < BENCH_STACK_SIZE && stack[untouched] == STACK_PAINT) {
+        untouched++;
+    }
+    free(stack);
+    return BENCH_STACK_SIZE - untouched;
+}
+
+static void bench_case_run(bench_case *c, long iterations, size_t stack_baseline)
+{
+    for (int path = PATH_V1; path <= PATH_SV2_EXT; path++) {
+        // Warm up caches and resolve lazily bound symbols before measuring
+        bench_run warmup = { .path = path, .c = c, .iterations = 16 };
+        bench_thread(&warmup);
+
+        bench_run run = { .path = path, .c = c, .iterations = iterations };
+        size_t stack_used = run_on_painted_stack(bench_thread, &run);
+
+        char allocs[16] = "n/a";
+#ifdef BENCH_WRAP_ALLOC
+        snprintf(allocs, sizeof(allocs), "%.2f", (double)run.allocs / iterations);
+#endif
+        printf("%-8s %-12s %7zu %6zu %10.1f %12s %10zu\n", path_names[path], c->name,
+               c->v1_coinbase.tx_len, c->notify.n_merkle_branches,
+               (double)run.elapsed_ns / iterations, allocs, stack_used - stack_baseline);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    // Thread start-up and TLS also live on the painted stack; report usage above that
+    size_t stack_baseline = run_on_painted_stack(idle_thread, NULL);
+
+    printf("%-8s %-12s %7s %6s %10s %12s %10s\n", "path", "payload", "cb B", "depth", "ns/job", "allocs/job", "stack B");
+
+    bench_case c;
+    for (size_t i = 0; i < RECORDED_NOTIFY_COUNT; i++) {
+        const bench_notify *src = &recorded_notifies[i];
+        if (!bench_case_init(&c, src, 0, src->n_merkle_branches)) {
+            fprintf(stderr, "failed to prepare %s\n", src->name);
+            return 1;
+        }
+        bench_case_run(&c, iterations, stack_baseline);
+        bench_case_free(&c);
+    }
+
+    const bench_notify *base = &recorded_notifies[RECORDED_NOTIFY_COUNT - 1];
+    for (size_t i = 0; i < SWEEP_COUNT; i++) {
+        if (!bench_case_init(&c, base, sweeps[i].extra_coinbase_bytes, sweeps[i].n_merkle_branches)) {
+            fprintf(stderr, "failed to prepare sweep %zu\n", i);
+            return 1;
+        }
+        snprintf(c.name, sizeof(c.name), "sweep-%zu", i);
+        bench_case_run(&c, iterations, stack_baseline);
+        bench_case_free(&c);
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sha256_kernels.h"
+
+#define DEFAULT_ITERATIONS 1000000
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t elapsed_ns, long iterations)
+{
+    printf("%-20s %8.1f ns/hash %12.0f hashes/s\n", name, (double)elapsed_ns / iterations,
+           iterations * 1e9 / (double)elapsed_ns);
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t data[80];
+    uint8_t hash[32];
+    for (int i = 0; i < 80; i++) {
+        data[i] = (uint8_t)(i * 31);
+    }
+
+    // Feed each result back into the input so the loops cannot be optimised away
+    uint64_t start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sha256d_80(data, hash);
+        data[76] ^= hash[0];
+    }
+    report("sha256d_80", now_ns() - start, iterations);
+
+    start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sha256d_64(data, data);
+    }
+    report("sha256d_64", now_ns() - start, iterations);
+
+    start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sha256_midstate_64(data, hash);
+        data[0] ^= hash[0];
+    }
+    report("sha256_midstate_64", now_ns() - start, iterations);
+
+    // Nonce verification: second block and outer hash only
+    start = now_ns();
+    for (long i = 0; i < iterations; i++) {
+        sha256d_80_midstate(hash, data + 64, data);
+        data[76] ^= data[0];
+    }
+    report("sha256d_80_midstate", now_ns() - start, iterations);
+
+    return 0;
+}
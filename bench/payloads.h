@@ -0,0 +1,111 @@
+#ifndef BENCH_PAYLOADS_H_
+#define BENCH_PAYLOADS_H_
+
+#include <stdint.h>
+
+#define BENCH_MAX_BRANCHES 16
+
+// A mining.notify as received from a pool, plus the subscribe-time extranonce
+// parameters needed to build jobs from it. Hex fields are as sent on the wire.
+typedef struct
+{
+    const char *name;
+    const char *job_id;
+    const char *prev_block_hash;
+    const char *coinbase_1;
+    const char *coinbase_2;
+    const char *merkle_branches[BENCH_MAX_BRANCHES];
+    int n_merkle_branches;
+    uint32_t version;
+    uint32_t nbits;
+    uint32_t ntime;
+    const char *extranonce_1;
+    int extranonce_2_len;
+} bench_notify;
+
+// Recorded notifies (the same ones the stratum unit tests use), smallest first.
+static const bench_notify recorded_notifies[] = {
+    {
+        .name = "slush-solo",
+        .job_id = "1b",
+        .prev_block_hash = "bf44fd3513dc7b837d60e5c628b572b448d204a8000007490000000000000000",
+        .coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20020862062f503253482f04b8864e5008",
+        .coinbase_2 = "072f736c7573682f000000000100f2052a010000001976a914d23fcdf86f7e756a64a7a9688ef9903327048ed988ac00000000",
+        .n_merkle_branches = 0,
+        .version = 0x20000004,
+        .nbits = 0x1705dd01,
+        .ntime = 0x64658bd8,
+        .extranonce_1 = "e9695791",
+        .extranonce_2_len = 4,
+    },
+    {
+        .name = "coinhunter",
+        .job_id = "4f2a",
+        .prev_block_hash = "bf44fd3513dc7b837d60e5c628b572b448d204a8000007490000000000000000",
+        .coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff2503777d07062f503253482f0405b8c75208f800880e000000000b2f436f696e48756e74722f0000000001",
+        .coinbase_2 = "1976a914c633315d376c20a973a758f7422d67f7bfed9c5888ac00000000",
+        .merkle_branches = {
+            "f0dbca1ee1a9f6388d07d97c1ab0de0e41acdf2edac4b95780ba0a1ec14103b3",
+            "8e43fd2988ac40c5d97702b7e5ccdf5b06d58f0e0d323f74dd5082232c1aedf7",
+            "1177601320ac928b8c145d771dae78a3901a089fa4aca8def01cbff747355818",
+            "9f64f3b0d9edddb14be6f71c3ac2e80455916e207ffc003316c6a515452aa7b4",
+            "2d0b54af60fad4ae59ec02031f661d026f2bb95e2eeb1e6657a35036c017c595",
+        },
+        .n_merkle_branches = 5,
+        .version = 0x20000004,
+        .nbits = 0x1705dd01,
+        .ntime = 0x64658bd8,
+        .extranonce_1 = "603f352a",
+        .extranonce_2_len = 4,
+    },
+    {
+        .name = "slush-pool",
+        .job_id = "1d2e0c4d3d",
+        .prev_block_hash = "ef4b9a48c7986466de4adc002f7337a6e121bc43000376ea0000000000000000",
+        .coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff4b03a5020cfabe6d6d379ae882651f6469f2ed6b8b40a4f9a4b41fd838a3ad6de8cba775f4e8f1d3080100000000000000",
+        .coinbase_2 = "41903d4c1b2f736c7573682f0000000003ca890d27000000001976a9147c154ed1dc59609e3d26abb2df2ea3d587cd8c4188ac00000000000000002c6a4c2952534b424c4f434b3a4cb4cb2ddfc37c41baf5ef6b6b4899e3253a8f1dfc7e5dd68a5b5b27005014ef0000000000000000266a24aa21a9ed5caa249f1af9fbf71c986fea8e076ca34ae3514fb2f86400561b28c7b15949bf00000000",
+        .merkle_branches = {
+            "ae23055e00f0f697cc3640124812d96d4fe8bdfa03484c1c638ce5a1c0e9aa81",
+            "980fb87cb61021dd7afd314fcb0dabd096f3d56a7377f6f320684652e7410a21",
+            "a52e9868343c55ce405be8971ff340f562ae9ab6353f07140d01666180e19b52",
+            "7435bdfa004e603953b2ed39f118803934d9cf17b06d979ceb682f2251bafac2",
+            "2a91f061a22d27cb8f44eea79938fb241ebeb359891aa907f05ffde7ed44e52e",
+            "302401f80eb5e958155135e25200bb8ea181ad2d05e804a531c7314d86403cdc",
+            "318ecb6161eb9b4cfd802bd730e2d36c167ddf102e70aa7b4158e2870dd47392",
+            "1114332a9858e0cf84b2425bb1e59eaabf91dd102d114aa443d57fc1b3beb0c9",
+            "f43f38095c810613ed795a44d9fab02ff25269706f454885db9be05cdf9c06e1",
+            "3e2fc26b27fddc39668b59099cd9635761bb72ed92404204e12bdff08b16fb75",
+            "463c19427286342120039a83218fa87ce45448e246895abac11fff0036076758",
+            "03d287f655813e540ddb9c4e7aeb922478662b0f5d8e9d0cbd564b20146bab76",
+        },
+        .n_merkle_branches = 12,
+        .version = 0x20000004,
+        .nbits = 0x1705c739,
+        .ntime = 0x64495522,
+        .extranonce_1 = "4de05269",
+        .extranonce_2_len = 8,
+    },
+};
+
+#define RECORDED_NOTIFY_COUNT (sizeof(recorded_notifies) / sizeof(recorded_notifies[0]))
+
+// Synthetic variants of the largest recorded notify: coinbase_2 padded with extra
+// output bytes and the merkle path cut or extended (branches repeat cyclically).
+typedef struct
+{
+    size_t extra_coinbase_bytes;
+    int n_merkle_branches;
+} bench_sweep;
+
+static const bench_sweep sweeps[] = {
+    { 0, 0 },
+    { 0, 4 },
+    { 0, 8 },
+    { 0, 16 },
+    { 1024, 12 },
+    { 4096, 12 },
+};
+
+#define SWEEP_COUNT (sizeof(sweeps) / sizeof(sweeps[0]))
+
+#endif // BENCH_PAYLOADS_H_
@@ -0,0 +1,5 @@
+// Host stand-in, used by the benchmarks only: there is no PSRAM on the host
+#pragma once
+#include <stdbool.h>
+
+static inline bool esp_psram_is_initialized(void) { return false; }
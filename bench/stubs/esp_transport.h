@@ -0,0 +1,4 @@
+// Host stand-in so stratum_api.h (mining_notify) can be included, used by the benchmarks only
+#pragma once
+
+typedef struct esp_transport_item_t *esp_transport_handle_t;
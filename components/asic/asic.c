@@ -167,23 +167,36 @@ double ASIC_get_asic_job_frequency_ms(GlobalState * GLOBAL_STATE)
     return 500;
 }
 
+uint16_t ASIC_read_register_mask(GlobalState * GLOBAL_STATE)
+{
+    switch (GLOBAL_STATE->DEVICE_CONFIG.family.asic.id) {
+        case BM1397:
+            return BM1397_read_register_mask();
+        case BM1366:
+            return BM1366_read_register_mask();
+        case BM1368:
+            return BM1368_read_register_mask();
+        case BM1370:
+            return BM1370_read_register_mask();
+    }
+    return 0;
+}
+
 void ASIC_read_registers(GlobalState * GLOBAL_STATE)
 {
     switch (GLOBAL_STATE->DEVICE_CONFIG.family.asic.id) {
         case BM1397:
             BM1397_read_registers();
-            break;
+            return;
         case BM1366:
             BM1366_read_registers();
-            break;
+            return;
         case BM1368:
             BM1368_read_registers();
-            break;
+            return;
         case BM1370:
             BM1370_read_registers();
-            break;
-        default:
-            ESP_LOGE(TAG, "Unknown ASIC id %d — cannot read registers", GLOBAL_STATE->DEVICE_CONFIG.family.asic.id);
-            break;
+            return;
     }
+    ESP_LOGE(TAG, "Unknown ASIC id %d — cannot read registers", GLOBAL_STATE->DEVICE_CONFIG.family.asic.id);
 }
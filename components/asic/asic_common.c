@@ -7,12 +7,15 @@
 #include "serial.h"
 #include "esp_log.h"
 #include "crc.h"
+#include "asic_framer.h"
+#include "asic_packet.h"
 #include "esp_timer.h"
 
 #define PREAMBLE 0xAA55
 
 static const char * TAG = "common";
 static char asic_chain_error[96];
+static asic_framer rx_framer;
 
 static void format_asic_indices(char *buffer, size_t buffer_size, int first_index, int end_index)
 {
@@ -147,44 +150,96 @@ int count_asic_chips(uint16_t asic_count, uint16_t chip_id, int chip_id_response
 
 esp_err_t receive_work(uint8_t * buffer, int buffer_size, uint64_t *out_timestamp_us)
 {
-    int received = SERIAL_rx(buffer, buffer_size, 10000);
-    if (out_timestamp_us) {
-        *out_timestamp_us = esp_timer_get_time();
+    // Let the FIFO-full interrupt fire as soon as one whole response is in;
+    // shorter bursts are reported by the RX idle timeout
+    static int rx_threshold;
+    if (rx_threshold != buffer_size && SERIAL_set_rx_threshold(buffer_size) == ESP_OK) {
+        rx_threshold = buffer_size;
     }
 
-    if (received < 0) {
-        ESP_LOGE(TAG, "UART error in serial RX");
-        return ESP_FAIL;
-    }
+    // Frames already sitting in the framer (read along with an earlier one) go out first
+    while (!asic_framer_pop(&rx_framer, buffer, buffer_size)) {
+        // Sleeps on the UART event queue, then drains what the driver has buffered
+        uint8_t chunk[ASIC_FRAMER_BUFFER_SIZE];
+        int received = SERIAL_rx_available(chunk, asic_framer_space(&rx_framer), 10000);
+
+        if (received < 0) {
+            // Bytes went missing somewhere after what the framer holds, so a partial
+            // response in it can't be completed; the ring buffer behind it is still good
+            ESP_LOGW(TAG, "UART dropped bytes in serial RX, discarding %d buffered byte(s)", rx_framer.length);
+            asic_framer_reset(&rx_framer);
+            continue;
+        }
 
-    if (received == 0) {
-        ESP_LOGD(TAG, "UART timeout in serial RX");
-        return ESP_FAIL;
+        if (received == 0) {
+            ESP_LOGD(TAG, "UART timeout in serial RX");
+            return ESP_FAIL;
+        }
+
+        asic_framer_push(&rx_framer, chunk, received, esp_timer_get_time());
+
+        uint32_t skipped = rx_framer.bytes_skipped;
+        if (asic_framer_pop(&rx_framer, buffer, buffer_size)) {
+            if (rx_framer.bytes_skipped != skipped) {
+                ESP_LOGW(TAG, "Resynced on response after skipping %lu byte(s)", rx_framer.bytes_skipped - skipped);
+            }
+            break;
+        }
+        if (rx_framer.bytes_skipped != skipped) {
+            ESP_LOGW(TAG, "Dropped %lu byte(s) without a valid response", rx_framer.bytes_skipped - skipped);
+        }
     }
 
-    if (received != buffer_size) {
-        ESP_LOGE(TAG, "Invalid response length %i", received);
-        ESP_LOG_BUFFER_HEX(TAG, buffer, received);
-        SERIAL_clear_buffer();
-        return ESP_FAIL;
+    if (out_timestamp_us) {
+        // Frames left in the framer by an earlier call keep their own read's time
+        *out_timestamp_us = rx_framer.frame_time_us;
     }
 
-    uint16_t received_preamble = (buffer[0] << 8) | buffer[1];
-    if (received_preamble != PREAMBLE) {
-        ESP_LOGE(TAG, "Preamble mismatch: got 0x%04x, expected 0x%04x", received_preamble, PREAMBLE);
-        ESP_LOG_BUFFER_HEX(TAG, buffer, received);
-        SERIAL_clear_buffer();
-        return ESP_FAIL;
+    return ESP_OK;
+}
+
+void clear_asic_rx(void)
+{
+    SERIAL_clear_buffer();
+    asic_framer_reset(&rx_framer);
+}
+
+void get_asic_rx_stats(uint32_t *resyncs, uint32_t *bytes_skipped)
+{
+    *resyncs = rx_framer.resyncs;
+    *bytes_skipped = rx_framer.bytes_skipped;
+}
+
+/// @brief Bit (1 << register_type) for every register in register_map
+uint16_t register_read_mask(const register_type_t *register_map, int map_size)
+{
+    uint16_t mask = 0;
+    for (int reg = 0; reg < map_size; reg++) {
+        if (register_map[reg] != REGISTER_INVALID) {
+            mask |= 1 << register_map[reg];
+        }
     }
+    return mask;
+}
+
+/// @brief Concatenates one read frame per mapped register so they can go out in a single write
+/// @return length of the burst in bytes
+int build_register_read_burst(const register_type_t *register_map, int map_size, uint8_t header, uint8_t *burst, int burst_size)
+{
+    int len = 0;
+
+    for (int reg = 0; reg < map_size; reg++) {
+        if (register_map[reg] == REGISTER_INVALID) continue;
 
-    if (crc5(buffer + 2, buffer_size - 2) != 0) {
-        ESP_LOGE(TAG, "Checksum failed on response");        
-        ESP_LOG_BUFFER_HEX(TAG, buffer, received);
-        SERIAL_clear_buffer();
-        return ESP_FAIL;
+        uint8_t body[] = {0x00, reg};
+        if (len + ASIC_PACKET_LEN(header, sizeof(body)) > burst_size) {
+            ESP_LOGE(TAG, "Register read burst too small");
+            break;
+        }
+        len += asic_packet_build(burst + len, header, body, sizeof(body));
     }
 
-    return ESP_OK;
+    return len;
 }
 
 void get_difficulty_mask(double difficulty, uint8_t *job_difficulty_mask)
@@ -0,0 +1,110 @@
+#include <string.h>
+
+#include "asic_framer.h"
+#include "crc.h"
+
+#define PREAMBLE_0 0xAA
+#define PREAMBLE_1 0x55
+
+void asic_framer_init(asic_framer *framer)
+{
+    memset(framer, 0, sizeof(asic_framer));
+}
+
+void asic_framer_reset(asic_framer *framer)
+{
+    framer->length = 0;
+    framer->in_resync = false;
+    framer->read_count = 0;
+}
+
+int asic_framer_space(const asic_framer *framer)
+{
+    return ASIC_FRAMER_BUFFER_SIZE - framer->length;
+}
+
+int asic_framer_push(asic_framer *framer, const uint8_t *data, int len, uint64_t time_us)
+{
+    int space = asic_framer_space(framer);
+    if (len > space) len = space;
+    if (len <= 0) return 0;
+
+    memcpy(framer->buffer + framer->length, data, len);
+    framer->length += len;
+
+    if (framer->read_count == ASIC_FRAMER_MAX_READS) {
+        // The oldest bytes take the next read's (later) time
+        framer->read_count--;
+        memmove(framer->reads, framer->reads + 1, framer->read_count * sizeof(framer->reads[0]));
+    }
+    framer->reads[framer->read_count].end = framer->length;
+    framer->reads[framer->read_count].time_us = time_us;
+    framer->read_count++;
+    return len;
+}
+
+static void drop(asic_framer *framer, int count)
+{
+    framer->length -= count;
+    memmove(framer->buffer, framer->buffer + count, framer->length);
+
+    int kept = 0;
+    for (int i = 0; i < framer->read_count; i++) {
+        framer->reads[i].end -= count;
+        if (framer->reads[i].end > 0) {
+            framer->reads[kept++] = framer->reads[i];
+        }
+    }
+    framer->read_count = kept;
+}
+
+// Time of the read that delivered byte offset (counted from the buffer start)
+static uint64_t byte_time(const asic_framer *framer, int offset)
+{
+    for (int i = 0; i < framer->read_count; i++) {
+        if (offset < framer->reads[i].end) return framer->reads[i].time_us;
+    }
+    return framer->read_count > 0 ? framer->reads[framer->read_count - 1].time_us : 0;
+}
+
+static void skip_byte(asic_framer *framer)
+{
+    if (!framer->in_resync) {
+        framer->in_resync = true;
+        framer->resyncs++;
+    }
+    framer->bytes_skipped++;
+    drop(framer, 1);
+}
+
+// True while the buffered bytes could still be the start of a frame
+static bool preamble_prefix(const asic_framer *framer)
+{
+    if (framer->length >= 1 && framer->buffer[0] != PREAMBLE_0) return false;
+    if (framer->length >= 2 && framer->buffer[1] != PREAMBLE_1) return false;
+    return true;
+}
+
+bool asic_framer_pop(asic_framer *framer, uint8_t *frame, int frame_size)
+{
+    while (framer->length > 0) {
+        if (!preamble_prefix(framer)) {
+            skip_byte(framer);
+            continue;
+        }
+        if (framer->length < frame_size) return false;
+
+        if (crc5(framer->buffer + 2, frame_size - 2) != 0) {
+            skip_byte(framer);
+            continue;
+        }
+
+        memcpy(frame, framer->buffer, frame_size);
+        framer->frame_time_us = byte_time(framer, frame_size - 1);
+        drop(framer, frame_size);
+        framer->in_resync = false;
+        framer->frames++;
+        return true;
+    }
+    return false;
+}
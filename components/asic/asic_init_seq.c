@@ -0,0 +1,78 @@
+#include <string.h>
+
+#include "asic_init_seq.h"
+#include "asic_packet.h"
+#include "serial.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char * TAG = "asic_init";
+
+static void flush(asic_init_batch *batch)
+{
+    if (batch->length == 0) return;
+
+    if (SERIAL_send(batch->buffer, batch->length, batch->debug) == 0) {
+        ESP_LOGE(TAG, "%s: failed to send %d bytes", batch->phase, batch->length);
+    }
+    batch->writes++;
+    batch->length = 0;
+}
+
+void asic_init_begin(asic_init_batch *batch, const char *phase, bool debug)
+{
+    batch->phase = phase;
+    batch->start_us = esp_timer_get_time();
+    batch->length = 0;
+    batch->frames = 0;
+    batch->writes = 0;
+    batch->delay_ms = 0;
+    batch->debug = debug;
+}
+
+void asic_init_add(asic_init_batch *batch, uint8_t header, const uint8_t *body, uint8_t body_len)
+{
+    if (batch->length + ASIC_PACKET_LEN(header, body_len) > ASIC_INIT_BUFFER_SIZE) {
+        flush(batch);
+    }
+    batch->length += asic_packet_build(batch->buffer + batch->length, header, body, body_len);
+    batch->frames++;
+}
+
+void asic_init_steps(asic_init_batch *batch, const asic_init_step *steps, int count, uint8_t chip_address)
+{
+    for (int i = 0; i < count; i++) {
+        const asic_init_step *step = &steps[i];
+
+        if (step->flags & ASIC_INIT_PER_CHIP) {
+            uint8_t body[ASIC_INIT_MAX_BODY];
+            memcpy(body, step->body, step->body_len);
+            body[0] = chip_address;
+            asic_init_add(batch, step->header, body, step->body_len);
+        } else {
+            asic_init_add(batch, step->header, step->body, step->body_len);
+        }
+
+        if (step->post_delay_ms > 0) {
+            asic_init_delay(batch, step->post_delay_ms);
+        }
+    }
+}
+
+void asic_init_delay(asic_init_batch *batch, uint32_t delay_ms)
+{
+    flush(batch);
+    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+    batch->delay_ms += delay_ms;
+}
+
+void asic_init_end(asic_init_batch *batch)
+{
+    flush(batch);
+    ESP_LOGI(TAG, "%s: %d commands in %d write(s), %lu ms of delays, %lld ms total",
+             batch->phase, batch->frames, batch->writes, batch->delay_ms,
+             (esp_timer_get_time() - batch->start_us) / 1000);
+}
@@ -0,0 +1,52 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "asic_packet.h"
+#include "crc.h"
+
+static int write_crc(uint8_t *frame, uint8_t body_len, uint16_t prefix_crc)
+{
+    uint8_t *body = frame + 4;
+
+    if (frame[2] & ASIC_PACKET_TYPE_JOB) {
+        uint16_t crc = crc16_false_update(prefix_crc, body, body_len);
+        body[body_len] = (crc >> 8) & 0xFF;
+        body[body_len + 1] = crc & 0xFF;
+    } else {
+        body[body_len] = crc5_update(prefix_crc, body, body_len);
+    }
+
+    return ASIC_PACKET_LEN(frame[2], body_len);
+}
+
+static uint16_t write_prefix(uint8_t *frame, uint8_t header, uint8_t body_len)
+{
+    bool is_job = header & ASIC_PACKET_TYPE_JOB;
+
+    frame[0] = 0x55;
+    frame[1] = 0xAA;
+    frame[2] = header;
+    // the length field counts header, length and crc bytes as well
+    frame[3] = ASIC_PACKET_LEN(header, body_len) - 2;
+
+    return is_job ? crc16_false_update(CRC16_FALSE_INIT, frame + 2, 2) : crc5_update(CRC5_INIT, frame + 2, 2);
+}
+
+int asic_packet_build(uint8_t *packet, uint8_t header, const uint8_t *body, uint8_t body_len)
+{
+    uint16_t prefix_crc = write_prefix(packet, header, body_len);
+    memcpy(packet + 4, body, body_len);
+    return write_crc(packet, body_len, prefix_crc);
+}
+
+void asic_packet_template_init(asic_packet_template *packet, uint8_t header, uint8_t body_len)
+{
+    memset(packet, 0, sizeof(asic_packet_template));
+    packet->body_len = body_len;
+    packet->prefix_crc = write_prefix(packet->frame, header, body_len);
+}
+
+int asic_packet_template_seal(asic_packet_template *packet)
+{
+    return write_crc(packet->frame, packet->body_len, packet->prefix_crc);
+}
@@ -1,7 +1,9 @@
 #include "bm1366.h"
 
-#include "crc.h"
+#include "asic_packet.h"
+#include "asic_init_seq.h"
 #include "global_state.h"
+#include "job_table.h"
 #include "serial.h"
 #include "utils.h"
 
@@ -84,32 +86,8 @@ static int address_interval;
 /// @param len
 static void _send_BM1366(uint8_t header, uint8_t * data, uint8_t data_len, bool debug)
 {
-    packet_type_t packet_type = (header & TYPE_JOB) ? JOB_PACKET : CMD_PACKET;
-    uint8_t total_length = (packet_type == JOB_PACKET) ? (data_len + 6) : (data_len + 5);
-
-    uint8_t buf[total_length];
-
-    // add the preamble
-    buf[0] = 0x55;
-    buf[1] = 0xAA;
-
-    // add the header field
-    buf[2] = header;
-
-    // add the length field
-    buf[3] = (packet_type == JOB_PACKET) ? (data_len + 4) : (data_len + 3);
-
-    // add the data
-    memcpy(buf + 4, data, data_len);
-
-    // add the correct crc type
-    if (packet_type == JOB_PACKET) {
-        uint16_t crc16_total = crc16_false(buf + 2, data_len + 2);
-        buf[4 + data_len] = (crc16_total >> 8) & 0xFF;
-        buf[5 + data_len] = crc16_total & 0xFF;
-    } else {
-        buf[4 + data_len] = crc5(buf + 2, data_len + 2);
-    }
+    uint8_t buf[ASIC_PACKET_LEN(header, data_len)];
+    int total_length = asic_packet_build(buf, header, data, data_len);
 
     // send serial data
     SERIAL_send(buf, total_length, debug);
@@ -122,28 +100,21 @@ static void _send_simple(uint8_t * data, uint8_t total_length)
     SERIAL_send(buf, total_length, BM1366_SERIALTX_DEBUG);
 }
 
-static void _send_chain_inactive(void)
-{
-    unsigned char read_address[2] = {0x00, 0x00};
-    // send serial data
-    _send_BM1366((TYPE_CMD | GROUP_ALL | CMD_INACTIVE), read_address, 2, BM1366_SERIALTX_DEBUG);
-}
-
-static void _set_chip_address(uint8_t chipAddr)
+static void _version_mask_cmd(uint32_t version_mask, uint8_t version_cmd[6])
 {
-    ESP_LOGI(TAG, "Set chip address: 0x%02x", chipAddr);
-
-    unsigned char read_address[2] = {chipAddr, 0x00};
-    // send serial data
-    _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS), read_address, 2, BM1366_SERIALTX_DEBUG);
+    int versions_to_roll = version_mask >> 13;
+    version_cmd[0] = 0x00;
+    version_cmd[1] = 0xA4;
+    version_cmd[2] = 0x90;
+    version_cmd[3] = 0x00;
+    version_cmd[4] = (versions_to_roll >> 8);
+    version_cmd[5] = (versions_to_roll & 0xFF);
 }
 
 void BM1366_set_version_mask(uint32_t version_mask) 
 {
-    int versions_to_roll = version_mask >> 13;
-    uint8_t version_byte0 = (versions_to_roll >> 8);
-    uint8_t version_byte1 = (versions_to_roll & 0xFF); 
-    uint8_t version_cmd[] = {0x00, 0xA4, 0x90, 0x00, version_byte0, version_byte1};
+    uint8_t version_cmd[6];
+    _version_mask_cmd(version_mask, version_cmd);
     _send_BM1366(TYPE_CMD | GROUP_ALL | CMD_WRITE, version_cmd, 6, BM1366_SERIALTX_DEBUG);
 }
 
@@ -188,18 +159,67 @@ float BM1366_send_hash_frequency(float target_freq)
     return new_freq;
 }
 
+#define WRITE_ALL (TYPE_CMD | GROUP_ALL | CMD_WRITE)
+#define WRITE_SINGLE (TYPE_CMD | GROUP_SINGLE | CMD_WRITE)
+
+static const asic_init_step chain_steps[] = {
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0xA8, 0x00, 0x07, 0x00, 0x00, 0x03}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0xA8, 0x00, 0x07, 0x00, 0x00),
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x18, 0xFF, 0x0F, 0xC1, 0x00, 0x00}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x18, 0xFF, 0x0F, 0xC1, 0x00),
+    //{0x55, 0xAA, 0x53, 0x05, 0x00, 0x00, 0x03};
+    ASIC_INIT_CMD(TYPE_CMD | GROUP_ALL | CMD_INACTIVE, 0x00, 0x00),
+};
+
+static const asic_init_step address_steps[] = {
+    //{ 0x55, 0xAA, 0x40, 0x05, 0x00, 0x00, 0x1C };
+    ASIC_INIT_CHIP_CMD(TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS, 0x00, 0x00),
+};
+
+static const asic_init_step core_steps[] = {
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x3C, 0x80, 0x00, 0x85, 0x40, 0x0C}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x3C, 0x80, 0x00, 0x85, 0x40),
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x20, 0x19}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x20),
+};
+
+static const asic_init_step io_steps[] = {
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x54, 0x00, 0x00, 0x00, 0x03, 0x1D}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x54, 0x00, 0x00, 0x00, 0x03),
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x58, 0x02, 0x11, 0x11, 0x11, 0x06}
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x58, 0x02, 0x11, 0x11, 0x11),
+    //{0x55, 0xAA, 0x41, 0x09, 0x00, 0x2C, 0x00, 0x7C, 0x00, 0x03, 0x03}
+    ASIC_INIT_CMD(WRITE_SINGLE, 0x00, 0x2C, 0x00, 0x7C, 0x00, 0x03),
+    //S19XP Dump sends baudrate change here.. we wait until later.
+    //{0x55, 0xAA, 0x51, 0x09, 0x00, 0x28, 0x11, 0x30, 0x02, 0x00, 0x03}
+};
+
+static const asic_init_step chip_steps[] = {
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0xA8, 0x00, 0x07, 0x01, 0xF0),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x18, 0xF0, 0x00, 0xC1, 0x00),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x85, 0x40),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x20),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x82, 0xAA),
+};
+
 uint8_t BM1366_init(void * pvParameters)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *)pvParameters;
+    asic_init_batch batch;
+
+    asic_init_begin(&batch, "BM1366 detect", BM1366_SERIALTX_DEBUG);
 
     // set version mask
+    uint8_t version_cmd[6];
+    _version_mask_cmd(STRATUM_DEFAULT_VERSION_MASK, version_cmd);
     for (int i = 0; i < 3; i++) {
-        BM1366_set_version_mask(STRATUM_DEFAULT_VERSION_MASK);
+        asic_init_add(&batch, WRITE_ALL, version_cmd, 6);
     }
 
     // read register 00 on all chips
-    unsigned char init3[7] = {0x55, 0xAA, 0x52, 0x05, 0x00, 0x00, 0x0A};
-    _send_simple(init3, 7);
+    //{0x55, 0xAA, 0x52, 0x05, 0x00, 0x00, 0x0A}
+    asic_init_add(&batch, TYPE_CMD | GROUP_ALL | CMD_READ, (uint8_t[]){0x00, 0x00}, 2);
+    asic_init_end(&batch);
 
     uint16_t asic_count = GLOBAL_STATE->DEVICE_CONFIG.family.asic_count;
     int chip_counter = count_asic_chips(asic_count, BM1366_CHIP_ID, BM1366_CHIP_ID_RESPONSE_LENGTH);
@@ -208,60 +228,31 @@ uint8_t BM1366_init(void * pvParameters)
         return 0;
     }
 
-    unsigned char init4[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0xA8, 0x00, 0x07, 0x00, 0x00, 0x03};
-    _send_simple(init4, 11);
-
-    unsigned char init5[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x18, 0xFF, 0x0F, 0xC1, 0x00, 0x00};
-    _send_simple(init5, 11);
-
-    //{0x55, 0xAA, 0x53, 0x05, 0x00, 0x00, 0x03};
-    _send_chain_inactive();
+    asic_init_begin(&batch, "BM1366 chain setup", BM1366_SERIALTX_DEBUG);
+    asic_init_steps(&batch, chain_steps, ASIC_INIT_STEP_COUNT(chain_steps), 0);
 
     // split the chip address space evenly
     address_interval = 256 / chip_counter;
     for (uint8_t i = 0; i < chip_counter; i++) {
-        //{ 0x55, 0xAA, 0x40, 0x05, 0x00, 0x00, 0x1C };
-        _set_chip_address(i * address_interval);
+        ESP_LOGI(TAG, "Set chip address: 0x%02x", i * address_interval);
+        asic_init_steps(&batch, address_steps, ASIC_INIT_STEP_COUNT(address_steps), i * address_interval);
     }
 
-    unsigned char init135[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x3C, 0x80, 0x00, 0x85, 0x40, 0x0C};
-    _send_simple(init135, 11);
-
-    unsigned char init136[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x20, 0x19};
-    _send_simple(init136, 11);
+    asic_init_steps(&batch, core_steps, ASIC_INIT_STEP_COUNT(core_steps), 0);
 
     uint16_t difficulty = GLOBAL_STATE->DEVICE_CONFIG.family.asic.difficulty;
 
     //set difficulty mask
     uint8_t difficulty_mask[6];
     get_difficulty_mask(difficulty, difficulty_mask);
-    _send_BM1366((TYPE_CMD | GROUP_ALL | CMD_WRITE), difficulty_mask, 6, BM1366_SERIALTX_DEBUG);    
-
-    unsigned char init138[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x54, 0x00, 0x00, 0x00, 0x03, 0x1D};
-    _send_simple(init138, 11);
-
-    unsigned char init139[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x58, 0x02, 0x11, 0x11, 0x11, 0x06};
-    _send_simple(init139, 11);
+    asic_init_add(&batch, WRITE_ALL, difficulty_mask, 6);
 
-    unsigned char init171[11] = {0x55, 0xAA, 0x41, 0x09, 0x00, 0x2C, 0x00, 0x7C, 0x00, 0x03, 0x03};
-    _send_simple(init171, 11);
-
-    //S19XP Dump sends baudrate change here.. we wait until later.
-    // unsigned char init173[11] = {0x55, 0xAA, 0x51, 0x09, 0x00, 0x28, 0x11, 0x30, 0x02, 0x00, 0x03};
-    // _send_simple(init173, 11);
+    asic_init_steps(&batch, io_steps, ASIC_INIT_STEP_COUNT(io_steps), 0);
 
     for (uint8_t i = 0; i < chip_counter; i++) {
-        unsigned char set_a8_register[6] = {i * address_interval, 0xA8, 0x00, 0x07, 0x01, 0xF0};
-        _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_WRITE), set_a8_register, 6, BM1366_SERIALTX_DEBUG);
-        unsigned char set_18_register[6] = {i * address_interval, 0x18, 0xF0, 0x00, 0xC1, 0x00};
-        _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_WRITE), set_18_register, 6, BM1366_SERIALTX_DEBUG);
-        unsigned char set_3c_register_first[6] = {i * address_interval, 0x3C, 0x80, 0x00, 0x85, 0x40};
-        _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_WRITE), set_3c_register_first, 6, BM1366_SERIALTX_DEBUG);
-        unsigned char set_3c_register_second[6] = {i * address_interval, 0x3C, 0x80, 0x00, 0x80, 0x20};
-        _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_WRITE), set_3c_register_second, 6, BM1366_SERIALTX_DEBUG);
-        unsigned char set_3c_register_third[6] = {i * address_interval, 0x3C, 0x80, 0x00, 0x82, 0xAA};
-        _send_BM1366((TYPE_CMD | GROUP_SINGLE | CMD_WRITE), set_3c_register_third, 6, BM1366_SERIALTX_DEBUG);
+        asic_init_steps(&batch, chip_steps, ASIC_INIT_STEP_COUNT(chip_steps), i * address_interval);
     }
+    asic_init_end(&batch);
 
     do_frequency_transition(GLOBAL_STATE, BM1366_send_hash_frequency);
 
@@ -304,40 +295,37 @@ int BM1366_set_max_baud(void)
 }
 
 static uint8_t id = 0;
+static asic_packet_template tx_job;
 
 void BM1366_send_work(void * pvParameters, bm_job * next_bm_job)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
 
-    BM1366_job job;
-    id = (id + 8) % 128;
-    job.job_id = id;
-    job.num_midstates = 0x01;
-    memcpy(&job.starting_nonce, &next_bm_job->starting_nonce, 4);
-    memcpy(&job.nbits, &next_bm_job->target, 4);
-    memcpy(&job.ntime, &next_bm_job->ntime, 4);
-    memcpy(job.merkle_root, next_bm_job->merkle_root, 32);
-    memcpy(job.prev_block_hash, next_bm_job->prev_block_hash, 32);
-    memcpy(&job.version, &next_bm_job->version, 4);
-
-    // Hold valid_jobs_lock across the free + reassignment so the result task
-    // (which snapshots active_jobs[job_id] under the same lock) can never observe
-    // or copy a slot we are freeing/replacing here. valid_jobs is set inside the
-    // same critical section so validity and the pointer stay consistent.
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] != NULL) {
-        free_bm_job(GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id]);
+    // Preamble, header and length are written once; only the body and crc change per job
+    if (tx_job.body_len == 0) {
+        asic_packet_template_init(&tx_job, TYPE_JOB | GROUP_SINGLE | CMD_WRITE, sizeof(BM1366_job));
     }
-    GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] = next_bm_job;
-    GLOBAL_STATE->valid_jobs[job.job_id] = 1;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    BM1366_job *job = (BM1366_job *)asic_packet_template_body(&tx_job);
+
+    id = (id + 8) % 128;
+    job->job_id = id;
+    job->num_midstates = 0x01;
+    memcpy(&job->starting_nonce, &next_bm_job->starting_nonce, 4);
+    memcpy(&job->nbits, &next_bm_job->target, 4);
+    memcpy(&job->ntime, &next_bm_job->ntime, 4);
+    memcpy(job->merkle_root, next_bm_job->merkle_root, 32);
+    memcpy(job->prev_block_hash, next_bm_job->prev_block_hash, 32);
+    memcpy(&job->version, &next_bm_job->version, 4);
+
+    // Publish before sending so a nonce for this job id always finds it
+    job_table_publish(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job->job_id, next_bm_job);
 
     //debug sent jobs - this can get crazy if the interval is short
     #if BM1366_DEBUG_JOBS
-    ESP_LOGI(TAG, "Send Job: %02X", job.job_id);
+    ESP_LOGI(TAG, "Send Job: %02X", job->job_id);
     #endif
 
-    _send_BM1366((TYPE_JOB | GROUP_SINGLE | CMD_WRITE), (uint8_t *)&job, sizeof(BM1366_job), BM1366_DEBUG_WORK);
+    SERIAL_send(tx_job.frame, asic_packet_template_seal(&tx_job), BM1366_DEBUG_WORK);
 }
 
 task_result * BM1366_process_work(void * pvParameters)
@@ -371,17 +359,15 @@ task_result * BM1366_process_work(void * pvParameters)
 
     GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
 
-    // Read active_jobs[job_id] under the lock
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->valid_jobs[job_id] == 0 || GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id] == NULL) {
-        pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    uint32_t job_version, job_version_mask, job_generation;
+    if (!job_table_read_version(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job_id, &job_version, &job_version_mask, &job_generation)) {
         ESP_LOGW(TAG, "Invalid job nonce found, 0x%02X", job_id);
         return NULL;
     }
-    uint32_t rolled_version = GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id]->version | version_bits;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    uint32_t rolled_version = job_version | version_bits;
 
     result.job_id = job_id;
+    result.job_generation = job_generation;
     result.nonce = asic_result.job.nonce;
     result.rolled_version = rolled_version;
     result.asic_nr = asic_nr;
@@ -391,13 +377,21 @@ task_result * BM1366_process_work(void * pvParameters)
     return &result;
 }
 
+uint16_t BM1366_read_register_mask(void)
+{
+    return register_read_mask(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]));
+}
+
+// All reads go out in one write; every chip answers each broadcast read
 void BM1366_read_registers(void)
 {
-    int size = sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]);
-    for (int reg = 0; reg < size; reg++) {
-        if (REGISTER_MAP[reg] != REGISTER_INVALID) {
-            _send_BM1366((TYPE_CMD | GROUP_ALL | CMD_READ), (uint8_t[]){0x00, reg}, 2, BM1366_SERIALTX_DEBUG);
-            vTaskDelay(1 / portTICK_PERIOD_MS);
-        }
+    static uint8_t burst[REGISTER_READ_BURST_MAX];
+    static int burst_len;
+
+    if (burst_len == 0) {
+        burst_len = build_register_read_burst(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]),
+                                              TYPE_CMD | GROUP_ALL | CMD_READ, burst, sizeof(burst));
     }
+
+    SERIAL_send(burst, burst_len, BM1366_SERIALTX_DEBUG);
 }
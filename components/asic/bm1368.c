@@ -1,7 +1,9 @@
 #include "bm1368.h"
 
-#include "crc.h"
+#include "asic_packet.h"
+#include "asic_init_seq.h"
 #include "global_state.h"
+#include "job_table.h"
 #include "serial.h"
 #include "utils.h"
 
@@ -80,47 +82,28 @@ static int address_interval;
 
 static void _send_BM1368(uint8_t header, uint8_t * data, uint8_t data_len, bool debug)
 {
-    packet_type_t packet_type = (header & TYPE_JOB) ? JOB_PACKET : CMD_PACKET;
-    uint8_t total_length = (packet_type == JOB_PACKET) ? (data_len + 6) : (data_len + 5);
-
-    uint8_t buf[total_length];
-
-    buf[0] = 0x55;
-    buf[1] = 0xAA;
-    buf[2] = header;
-    buf[3] = (packet_type == JOB_PACKET) ? (data_len + 4) : (data_len + 3);
-    memcpy(buf + 4, data, data_len);
-
-    if (packet_type == JOB_PACKET) {
-        uint16_t crc16_total = crc16_false(buf + 2, data_len + 2);
-        buf[4 + data_len] = (crc16_total >> 8) & 0xFF;
-        buf[5 + data_len] = crc16_total & 0xFF;
-    } else {
-        buf[4 + data_len] = crc5(buf + 2, data_len + 2);
-    }
+    uint8_t buf[ASIC_PACKET_LEN(header, data_len)];
+    int total_length = asic_packet_build(buf, header, data, data_len);
 
     SERIAL_send(buf, total_length, debug);
 }
 
 
-static void _send_chain_inactive(void)
-{
-    unsigned char read_address[2] = {0x00, 0x00};
-    _send_BM1368((TYPE_CMD | GROUP_ALL | CMD_INACTIVE), read_address, 2, BM1368_SERIALTX_DEBUG);
-}
-
-static void _set_chip_address(uint8_t chipAddr)
+static void _version_mask_cmd(uint32_t version_mask, uint8_t version_cmd[6])
 {
-    unsigned char read_address[2] = {chipAddr, 0x00};
-    _send_BM1368((TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS), read_address, 2, BM1368_SERIALTX_DEBUG);
+    int versions_to_roll = version_mask >> 13;
+    version_cmd[0] = 0x00;
+    version_cmd[1] = 0xA4;
+    version_cmd[2] = 0x90;
+    version_cmd[3] = 0x00;
+    version_cmd[4] = (versions_to_roll >> 8);
+    version_cmd[5] = (versions_to_roll & 0xFF);
 }
 
 void BM1368_set_version_mask(uint32_t version_mask) 
 {
-    int versions_to_roll = version_mask >> 13;
-    uint8_t version_byte0 = (versions_to_roll >> 8);
-    uint8_t version_byte1 = (versions_to_roll & 0xFF); 
-    uint8_t version_cmd[] = {0x00, 0xA4, 0x90, 0x00, version_byte0, version_byte1};
+    uint8_t version_cmd[6];
+    _version_mask_cmd(version_mask, version_cmd);
     _send_BM1368(TYPE_CMD | GROUP_ALL | CMD_WRITE, version_cmd, 6, BM1368_SERIALTX_DEBUG);
 }
 
@@ -165,16 +148,48 @@ float BM1368_send_hash_frequency(float target_freq)
     return new_freq;
 }
 
+#define WRITE_ALL (TYPE_CMD | GROUP_ALL | CMD_WRITE)
+#define WRITE_SINGLE (TYPE_CMD | GROUP_SINGLE | CMD_WRITE)
+
+static const asic_init_step chain_steps[] = {
+    ASIC_INIT_CMD(TYPE_CMD | GROUP_ALL | CMD_INACTIVE, 0x00, 0x00),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0xA8, 0x00, 0x07, 0x00, 0x00),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x18, 0xFF, 0x0F, 0xC1, 0x00),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x3C, 0x80, 0x00, 0x8b, 0x00),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x18),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x14, 0x00, 0x00, 0x00, 0xFF),
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x54, 0x00, 0x00, 0x00, 0x03), //Analog Mux
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, 0x58, 0x02, 0x11, 0x11, 0x11),
+};
+
+static const asic_init_step address_steps[] = {
+    ASIC_INIT_CHIP_CMD(TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS, 0x00, 0x00),
+};
+
+static const asic_init_step chip_steps[] = {
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0xA8, 0x00, 0x07, 0x01, 0xF0),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x18, 0xF0, 0x00, 0xC1, 0x00),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x8b, 0x00),
+    ASIC_INIT_CHIP_CMD(WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x80, 0x18),
+    ASIC_INIT_CHIP_CMD_DELAY(500, WRITE_SINGLE, 0x00, 0x3C, 0x80, 0x00, 0x82, 0xAA),
+};
+
 uint8_t BM1368_init(void * pvParameters)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *)pvParameters;
+    asic_init_batch batch;
+
+    asic_init_begin(&batch, "BM1368 detect", BM1368_SERIALTX_DEBUG);
 
     // set version mask
+    uint8_t version_cmd[6];
+    _version_mask_cmd(STRATUM_DEFAULT_VERSION_MASK, version_cmd);
     for (int i = 0; i < 4; i++) {
-        BM1368_set_version_mask(STRATUM_DEFAULT_VERSION_MASK);
+        asic_init_add(&batch, WRITE_ALL, version_cmd, 6);
     }
 
-    _send_BM1368(TYPE_CMD | GROUP_ALL | CMD_READ, (uint8_t[]){0x00, 0x00}, 2, false);
+    asic_init_add(&batch, TYPE_CMD | GROUP_ALL | CMD_READ, (uint8_t[]){0x00, 0x00}, 2);
+    asic_init_end(&batch);
 
     uint16_t asic_count = GLOBAL_STATE->DEVICE_CONFIG.family.asic_count;
     int chip_counter = count_asic_chips(asic_count, BM1368_CHIP_ID, BM1368_CHIP_ID_RESPONSE_LENGTH);
@@ -183,47 +198,24 @@ uint8_t BM1368_init(void * pvParameters)
         return 0;
     }
 
-    _send_chain_inactive();
-    
-    uint8_t init_cmds[][6] = {
-        {0x00, 0xA8, 0x00, 0x07, 0x00, 0x00},
-        {0x00, 0x18, 0xFF, 0x0F, 0xC1, 0x00},
-        {0x00, 0x3C, 0x80, 0x00, 0x8b, 0x00},
-        {0x00, 0x3C, 0x80, 0x00, 0x80, 0x18},
-        {0x00, 0x14, 0x00, 0x00, 0x00, 0xFF},
-        {0x00, 0x54, 0x00, 0x00, 0x00, 0x03}, //Analog Mux
-        {0x00, 0x58, 0x02, 0x11, 0x11, 0x11}
-    };
-
-    for (int i = 0; i < sizeof(init_cmds) / sizeof(init_cmds[0]); i++) {
-        _send_BM1368(TYPE_CMD | GROUP_ALL | CMD_WRITE, init_cmds[i], 6, false);
-    }
+    asic_init_begin(&batch, "BM1368 chain setup", BM1368_SERIALTX_DEBUG);
+    asic_init_steps(&batch, chain_steps, ASIC_INIT_STEP_COUNT(chain_steps), 0);
 
     address_interval = 256 / chip_counter;
     for (int i = 0; i < chip_counter; i++) {
-        _set_chip_address(i * address_interval);
+        asic_init_steps(&batch, address_steps, ASIC_INIT_STEP_COUNT(address_steps), i * address_interval);
     }
 
     for (int i = 0; i < chip_counter; i++) {
-        uint8_t chip_init_cmds[][6] = {
-            {i * address_interval, 0xA8, 0x00, 0x07, 0x01, 0xF0},
-            {i * address_interval, 0x18, 0xF0, 0x00, 0xC1, 0x00},
-            {i * address_interval, 0x3C, 0x80, 0x00, 0x8b, 0x00},
-            {i * address_interval, 0x3C, 0x80, 0x00, 0x80, 0x18},
-            {i * address_interval, 0x3C, 0x80, 0x00, 0x82, 0xAA}
-        };
-
-        for (int j = 0; j < sizeof(chip_init_cmds) / sizeof(chip_init_cmds[0]); j++) {
-            _send_BM1368(TYPE_CMD | GROUP_SINGLE | CMD_WRITE, chip_init_cmds[j], 6, false);
-        }
-        vTaskDelay(pdMS_TO_TICKS(500));
+        asic_init_steps(&batch, chip_steps, ASIC_INIT_STEP_COUNT(chip_steps), i * address_interval);
     }
 
     uint16_t difficulty = GLOBAL_STATE->DEVICE_CONFIG.family.asic.difficulty;
 
     uint8_t difficulty_mask[6];
     get_difficulty_mask(difficulty, difficulty_mask);
-    _send_BM1368((TYPE_CMD | GROUP_ALL | CMD_WRITE), difficulty_mask, 6, BM1368_SERIALTX_DEBUG);    
+    asic_init_add(&batch, WRITE_ALL, difficulty_mask, 6);
+    asic_init_end(&batch);
 
     do_frequency_transition(GLOBAL_STATE, BM1368_send_hash_frequency);
 
@@ -254,39 +246,36 @@ int BM1368_set_max_baud(void)
 }
 
 static uint8_t id = 0;
+static asic_packet_template tx_job;
 
 void BM1368_send_work(void * pvParameters, bm_job * next_bm_job)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
 
-    BM1368_job job;
-    id = (id + 24) % 128;
-    job.job_id = id;
-    job.num_midstates = 0x01;
-    memcpy(&job.starting_nonce, &next_bm_job->starting_nonce, 4);
-    memcpy(&job.nbits, &next_bm_job->target, 4);
-    memcpy(&job.ntime, &next_bm_job->ntime, 4);
-    memcpy(job.merkle_root, next_bm_job->merkle_root, 32);
-    memcpy(job.prev_block_hash, next_bm_job->prev_block_hash, 32);
-    memcpy(&job.version, &next_bm_job->version, 4);
-
-    // Hold valid_jobs_lock across the free + reassignment so the result task
-    // (which snapshots active_jobs[job_id] under the same lock) can never observe
-    // or copy a slot we are freeing/replacing here. valid_jobs is set inside the
-    // same critical section so validity and the pointer stay consistent.
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] != NULL) {
-        free_bm_job(GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id]);
+    // Preamble, header and length are written once; only the body and crc change per job
+    if (tx_job.body_len == 0) {
+        asic_packet_template_init(&tx_job, TYPE_JOB | GROUP_SINGLE | CMD_WRITE, sizeof(BM1368_job));
     }
-    GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] = next_bm_job;
-    GLOBAL_STATE->valid_jobs[job.job_id] = 1;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    BM1368_job *job = (BM1368_job *)asic_packet_template_body(&tx_job);
+
+    id = (id + 24) % 128;
+    job->job_id = id;
+    job->num_midstates = 0x01;
+    memcpy(&job->starting_nonce, &next_bm_job->starting_nonce, 4);
+    memcpy(&job->nbits, &next_bm_job->target, 4);
+    memcpy(&job->ntime, &next_bm_job->ntime, 4);
+    memcpy(job->merkle_root, next_bm_job->merkle_root, 32);
+    memcpy(job->prev_block_hash, next_bm_job->prev_block_hash, 32);
+    memcpy(&job->version, &next_bm_job->version, 4);
+
+    // Publish before sending so a nonce for this job id always finds it
+    job_table_publish(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job->job_id, next_bm_job);
 
     #if BM1368_DEBUG_JOBS
-    ESP_LOGI(TAG, "⁠​‌‌​​​‌​​‌‌​‌​​‌​‌‌‌​‌​​​‌‌​​​​‌​‌‌‌‌​​​​‌‌​​‌​‌⁠Send Job: %02X", job.job_id);
+    ESP_LOGI(TAG, "⁠​‌‌​​​‌​​‌‌​‌​​‌​‌‌‌​‌​​​‌‌​​​​‌​‌‌‌‌​​​​‌‌​​‌​‌⁠Send Job: %02X", job->job_id);
     #endif
 
-    _send_BM1368((TYPE_JOB | GROUP_SINGLE | CMD_WRITE), (uint8_t *)&job, sizeof(BM1368_job), BM1368_DEBUG_WORK);
+    SERIAL_send(tx_job.frame, asic_packet_template_seal(&tx_job), BM1368_DEBUG_WORK);
 }
 
 task_result * BM1368_process_work(void * pvParameters)
@@ -320,17 +309,15 @@ task_result * BM1368_process_work(void * pvParameters)
 
     GlobalState * GLOBAL_STATE = (GlobalState *) pvParameters;
 
-    // Read active_jobs[job_id] under the lock
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->valid_jobs[job_id] == 0 || GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id] == NULL) {
-        pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    uint32_t job_version, job_version_mask, job_generation;
+    if (!job_table_read_version(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job_id, &job_version, &job_version_mask, &job_generation)) {
         ESP_LOGW(TAG, "Invalid job nonce found, 0x%02X", job_id);
         return NULL;
     }
-    uint32_t rolled_version = GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id]->version | version_bits;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    uint32_t rolled_version = job_version | version_bits;
 
     result.job_id = job_id;
+    result.job_generation = job_generation;
     result.nonce = asic_result.job.nonce;
     result.rolled_version = rolled_version;
     result.asic_nr = asic_nr;
@@ -340,13 +327,21 @@ task_result * BM1368_process_work(void * pvParameters)
     return &result;
 }
 
+uint16_t BM1368_read_register_mask(void)
+{
+    return register_read_mask(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]));
+}
+
+// All reads go out in one write; every chip answers each broadcast read
 void BM1368_read_registers(void)
 {
-    int size = sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]);
-    for (int reg = 0; reg < size; reg++) {
-        if (REGISTER_MAP[reg] != REGISTER_INVALID) {
-            _send_BM1368((TYPE_CMD | GROUP_ALL | CMD_READ), (uint8_t[]){0x00, reg}, 2, BM1368_SERIALTX_DEBUG);
-            vTaskDelay(1 / portTICK_PERIOD_MS);
-        }
+    static uint8_t burst[REGISTER_READ_BURST_MAX];
+    static int burst_len;
+
+    if (burst_len == 0) {
+        burst_len = build_register_read_burst(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]),
+                                              TYPE_CMD | GROUP_ALL | CMD_READ, burst, sizeof(burst));
     }
+
+    SERIAL_send(burst, burst_len, BM1368_SERIALTX_DEBUG);
 }
@@ -13,9 +13,11 @@
 #include "serial.h"
 #include "bm1397.h"
 #include "utils.h"
-#include "crc.h"
+#include "asic_packet.h"
+#include "asic_init_seq.h"
 #include "mining.h"
 #include "global_state.h"
+#include "job_table.h"
 #include "pll.h"
 
 #define BM1397_CHIP_ID 0x1397
@@ -88,35 +90,8 @@ static int address_interval;
 /// @param len
 static void _send_BM1397(uint8_t header, uint8_t *data, uint8_t data_len, bool debug)
 {
-    packet_type_t packet_type = (header & TYPE_JOB) ? JOB_PACKET : CMD_PACKET;
-    uint8_t total_length = (packet_type == JOB_PACKET) ? (data_len + 6) : (data_len + 5);
-
-    uint8_t buf[total_length];
-
-    // add the preamble
-    buf[0] = 0x55;
-    buf[1] = 0xAA;
-
-    // add the header field
-    buf[2] = header;
-
-    // add the length field
-    buf[3] = (packet_type == JOB_PACKET) ? (data_len + 4) : (data_len + 3);
-
-    // add the data
-    memcpy(buf + 4, data, data_len);
-
-    // add the correct crc type
-    if (packet_type == JOB_PACKET)
-    {
-        uint16_t crc16_total = crc16_false(buf + 2, data_len + 2);
-        buf[4 + data_len] = (crc16_total >> 8) & 0xFF;
-        buf[5 + data_len] = crc16_total & 0xFF;
-    }
-    else
-    {
-        buf[4 + data_len] = crc5(buf + 2, data_len + 2);
-    }
+    uint8_t buf[ASIC_PACKET_LEN(header, data_len)];
+    int total_length = asic_packet_build(buf, header, data, data_len);
 
     // send serial data
     SERIAL_send(buf, total_length, debug);
@@ -129,20 +104,6 @@ static void _send_read_address(void)
     _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_READ), read_address, 2, BM1397_SERIALTX_DEBUG);
 }
 
-static void _send_chain_inactive(void)
-{
-    unsigned char read_address[2] = {0x00, 0x00};
-    // send serial data
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_INACTIVE), read_address, 2, BM1397_SERIALTX_DEBUG);
-}
-
-static void _set_chip_address(uint8_t chipAddr)
-{
-    unsigned char read_address[2] = {chipAddr, 0x00};
-    // send serial data
-    _send_BM1397((TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS), read_address, 2, BM1397_SERIALTX_DEBUG);
-}
-
 void BM1397_set_version_mask(uint32_t version_mask) 
 {
     // placeholder
@@ -178,9 +139,32 @@ float BM1397_send_hash_frequency(float target_freq)
     return frequency;
 }
 
+#define WRITE_ALL (TYPE_CMD | GROUP_ALL | CMD_WRITE)
+
+static const asic_init_step chain_steps[] = {
+    ASIC_INIT_CMD(TYPE_CMD | GROUP_ALL | CMD_INACTIVE, 0x00, 0x00),
+};
+
+static const asic_init_step address_steps[] = {
+    ASIC_INIT_CHIP_CMD(TYPE_CMD | GROUP_SINGLE | CMD_SETADDRESS, 0x00, 0x00),
+};
+
+static const asic_init_step clock_steps[] = {
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, CLOCK_ORDER_CONTROL_0, 0x00, 0x00, 0x00, 0x00), // init1 - clock_order_control0
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, CLOCK_ORDER_CONTROL_1, 0x00, 0x00, 0x00, 0x00), // init2 - clock_order_control1
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, ORDERED_CLOCK_ENABLE, 0x00, 0x00, 0x00, 0x01), // init3 - ordered_clock_enable
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, CORE_REGISTER_CONTROL, 0x80, 0x00, 0x80, 0x74), // init4 - init_4_?
+};
+
+static const asic_init_step pll_steps[] = {
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, PLL3_PARAMETER, 0xC0, 0x70, 0x01, 0x11), // init5 - pll3_parameter
+    ASIC_INIT_CMD(WRITE_ALL, 0x00, FAST_UART_CONFIGURATION, 0x06, 0x00, 0x00, 0x0F), // init6 - fast_uart_configuration
+};
+
 uint8_t BM1397_init(void * pvParameters)
 {
     GlobalState * GLOBAL_STATE = (GlobalState *)pvParameters;
+    asic_init_batch batch;
 
     // send the init command
     _send_read_address();
@@ -192,40 +176,27 @@ uint8_t BM1397_init(void * pvParameters)
         return 0;
     }
 
-    // send serial data
-    vTaskDelay(SLEEP_TIME / portTICK_PERIOD_MS);
-    _send_chain_inactive();
+    asic_init_begin(&batch, "BM1397 chain setup", BM1397_SERIALTX_DEBUG);
+    asic_init_delay(&batch, SLEEP_TIME);
+    asic_init_steps(&batch, chain_steps, ASIC_INIT_STEP_COUNT(chain_steps), 0);
 
     // split the chip address space evenly
     address_interval = 256 / chip_counter;
     for (uint8_t i = 0; i < chip_counter; i++) {
-        _set_chip_address(i * address_interval);
+        asic_init_steps(&batch, address_steps, ASIC_INIT_STEP_COUNT(address_steps), i * address_interval);
     }
 
-    unsigned char init[6] = {0x00, CLOCK_ORDER_CONTROL_0, 0x00, 0x00, 0x00, 0x00}; // init1 - clock_order_control0
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init, 6, BM1397_SERIALTX_DEBUG);
-
-    unsigned char init2[6] = {0x00, CLOCK_ORDER_CONTROL_1, 0x00, 0x00, 0x00, 0x00}; // init2 - clock_order_control1
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init2, 6, BM1397_SERIALTX_DEBUG);
-
-    unsigned char init3[9] = {0x00, ORDERED_CLOCK_ENABLE, 0x00, 0x00, 0x00, 0x01}; // init3 - ordered_clock_enable
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init3, 6, BM1397_SERIALTX_DEBUG);
-
-    unsigned char init4[9] = {0x00, CORE_REGISTER_CONTROL, 0x80, 0x00, 0x80, 0x74}; // init4 - init_4_?
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init4, 6, BM1397_SERIALTX_DEBUG);
+    asic_init_steps(&batch, clock_steps, ASIC_INIT_STEP_COUNT(clock_steps), 0);
 
     uint16_t difficulty = GLOBAL_STATE->DEVICE_CONFIG.family.asic.difficulty;
 
     //set difficulty mask
     uint8_t difficulty_mask[6];
     get_difficulty_mask(difficulty, difficulty_mask);
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), difficulty_mask, 6, BM1397_SERIALTX_DEBUG);
+    asic_init_add(&batch, WRITE_ALL, difficulty_mask, 6);
 
-    unsigned char init5[9] = {0x00, PLL3_PARAMETER, 0xC0, 0x70, 0x01, 0x11}; // init5 - pll3_parameter
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init5, 6, BM1397_SERIALTX_DEBUG);
-
-    unsigned char init6[9] = {0x00, FAST_UART_CONFIGURATION, 0x06, 0x00, 0x00, 0x0F}; // init6 - fast_uart_configuration
-    _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_WRITE), init6, 6, BM1397_SERIALTX_DEBUG);
+    asic_init_steps(&batch, pll_steps, ASIC_INIT_STEP_COUNT(pll_steps), 0);
+    asic_init_end(&batch);
 
     BM1397_set_default_baud();
 
@@ -256,50 +227,46 @@ int BM1397_set_max_baud(void)
 }
 
 static uint8_t id = 0;
+static asic_packet_template tx_job;
 
 void BM1397_send_work(void *pvParameters, bm_job *next_bm_job)
 {
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
-    job_packet job;
+    // Preamble, header and length are written once; only the body and crc change per job
+    if (tx_job.body_len == 0) {
+        asic_packet_template_init(&tx_job, TYPE_JOB | GROUP_SINGLE | CMD_WRITE, sizeof(job_packet));
+    }
+    job_packet *job = (job_packet *)asic_packet_template_body(&tx_job);
+
     // max job number is 128
     // there is still some really weird logic with the job id bits for the asic to sort out
     // so we have it limited to 128 and it has to increment by 4
     id = (id + 4) % 128;
 
-    job.job_id = id;
-    job.num_midstates = next_bm_job->num_midstates;
-    memcpy(&job.starting_nonce, &next_bm_job->starting_nonce, 4);
-    memcpy(&job.nbits, &next_bm_job->target, 4);
-    memcpy(&job.ntime, &next_bm_job->ntime, 4);
-    memcpy(&job.merkle4, next_bm_job->merkle_root, 4);
-    memcpy(job.midstate, next_bm_job->midstate, 32);
+    job->job_id = id;
+    job->num_midstates = next_bm_job->num_midstates;
+    memcpy(&job->starting_nonce, &next_bm_job->starting_nonce, 4);
+    memcpy(&job->nbits, &next_bm_job->target, 4);
+    memcpy(&job->ntime, &next_bm_job->ntime, 4);
+    memcpy(&job->merkle4, next_bm_job->merkle_root, 4);
+    memcpy(job->midstate, next_bm_job->midstate, 32);
 
-    if (job.num_midstates == 4)
+    if (job->num_midstates == 4)
     {
-        memcpy(job.midstate1, next_bm_job->midstate1, 32);
-        memcpy(job.midstate2, next_bm_job->midstate2, 32);
-        memcpy(job.midstate3, next_bm_job->midstate3, 32);
+        memcpy(job->midstate1, next_bm_job->midstate1, 32);
+        memcpy(job->midstate2, next_bm_job->midstate2, 32);
+        memcpy(job->midstate3, next_bm_job->midstate3, 32);
     }
 
-    // Hold valid_jobs_lock across the free + reassignment so the result task
-    // (which snapshots active_jobs[job_id] under the same lock) can never observe
-    // or copy a slot we are freeing/replacing here. valid_jobs is set inside the
-    // same critical section so validity and the pointer stay consistent.
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] != NULL)
-    {
-        free_bm_job(GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id]);
-    }
-    GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job.job_id] = next_bm_job;
-    GLOBAL_STATE->valid_jobs[job.job_id] = 1;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    // Publish before sending so a nonce for this job id always finds it
+    job_table_publish(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job->job_id, next_bm_job);
 
     #if BM1397_DEBUG_JOBS
-    ESP_LOGI(TAG, "Send Job: %02X", job.job_id);
+    ESP_LOGI(TAG, "Send Job: %02X", job->job_id);
     #endif
 
-    _send_BM1397((TYPE_JOB | GROUP_SINGLE | CMD_WRITE), (uint8_t *)&job, sizeof(job_packet), BM1397_DEBUG_WORK);
+    SERIAL_send(tx_job.frame, asic_packet_template_seal(&tx_job), BM1397_DEBUG_WORK);
 }
 
 task_result *BM1397_process_work(void *pvParameters)
@@ -332,20 +299,14 @@ task_result *BM1397_process_work(void *pvParameters)
 
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
-    // Read active_jobs[rx_job_id] under the lock: BM1397_send_work() can free and
-    // replace this slot from the create-jobs task, so dereferencing ->version /
-    // ->version_mask without the lock is a use-after-free. Snapshot both fields,
-    // then unlock and roll the version outside the critical section.
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    if (GLOBAL_STATE->valid_jobs[rx_job_id] == 0 || GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[rx_job_id] == NULL)
+    // BM1397_send_work() can rewrite this slot from the create-jobs task; the
+    // job table hands back version and mask from a single publication of it
+    uint32_t rolled_version, version_mask, job_generation;
+    if (!job_table_read_version(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, rx_job_id, &rolled_version, &version_mask, &job_generation))
     {
-        pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
         ESP_LOGW(TAG, "Invalid job nonce found, id=%d", rx_job_id);
         return NULL;
     }
-    uint32_t rolled_version = GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[rx_job_id]->version;
-    uint32_t version_mask = GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[rx_job_id]->version_mask;
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
 
     for (int i = 0; i < rx_midstate_index; i++)
     {
@@ -381,6 +342,7 @@ task_result *BM1397_process_work(void *pvParameters)
     uint8_t small_core_id = asic_result.job.id & 0x0f;
 
     result.job_id = rx_job_id;
+    result.job_generation = job_generation;
     result.nonce = asic_result.job.nonce;
     result.rolled_version = rolled_version;
     result.asic_nr = asic_nr;
@@ -390,13 +352,21 @@ task_result *BM1397_process_work(void *pvParameters)
     return &result;
 }
 
+uint16_t BM1397_read_register_mask(void)
+{
+    return register_read_mask(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]));
+}
+
+// All reads go out in one write; every chip answers each broadcast read
 void BM1397_read_registers(void)
 {
-    int size = sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]);
-    for (int reg = 0; reg < size; reg++) {
-        if (REGISTER_MAP[reg] != REGISTER_INVALID) {
-            _send_BM1397((TYPE_CMD | GROUP_ALL | CMD_READ), (uint8_t[]){0x00, reg}, 2, BM1397_SERIALTX_DEBUG);
-            vTaskDelay(1 / portTICK_PERIOD_MS);
-        }
+    static uint8_t burst[REGISTER_READ_BURST_MAX];
+    static int burst_len;
+
+    if (burst_len == 0) {
+        burst_len = build_register_read_burst(REGISTER_MAP, sizeof(REGISTER_MAP) / sizeof(REGISTER_MAP[0]),
+                                              TYPE_CMD | GROUP_ALL | CMD_READ, burst, sizeof(burst));
     }
+
+    SERIAL_send(burst, burst_len, BM1397_SERIALTX_DEBUG);
 }
@@ -2,25 +2,41 @@
 #include "crc.h"
 
 
-// Poly x⁵ + x² + 1 MSB-first
-uint8_t crc5(uint8_t *data, uint8_t len) {
-
-    uint8_t crc = 0x1F;
-    uint8_t bit_counter, byte_counter;
-
-    for (byte_counter = 0; byte_counter < len; byte_counter++) {
-        uint8_t byte = data[byte_counter];
-        for (bit_counter = 0; bit_counter < 8; bit_counter++) {
-            uint8_t bit = (byte >> 7) & 1;
-            byte <<= 1;
-
-            uint8_t new_bit = ((crc >> 4) ^ bit) & 1;
-            crc = ((crc << 1) | new_bit) ^ (new_bit << 2);
-            crc &= 0x1F;
-        }
+// Poly x⁵ + x² + 1 MSB-first, one byte at a time. The 5-bit crc is kept in
+// the top bits of a byte (crc << 3), so the table is a plain CRC-8 with poly 0x05 << 3.
+static const uint8_t crc5_table[256] = {
+	0x00, 0x28, 0x50, 0x78, 0xA0, 0x88, 0xF0, 0xD8, 0x68, 0x40, 0x38, 0x10, 0xC8, 0xE0, 0x98, 0xB0,
+	0xD0, 0xF8, 0x80, 0xA8, 0x70, 0x58, 0x20, 0x08, 0xB8, 0x90, 0xE8, 0xC0, 0x18, 0x30, 0x48, 0x60,
+	0x88, 0xA0, 0xD8, 0xF0, 0x28, 0x00, 0x78, 0x50, 0xE0, 0xC8, 0xB0, 0x98, 0x40, 0x68, 0x10, 0x38,
+	0x58, 0x70, 0x08, 0x20, 0xF8, 0xD0, 0xA8, 0x80, 0x30, 0x18, 0x60, 0x48, 0x90, 0xB8, 0xC0, 0xE8,
+	0x38, 0x10, 0x68, 0x40, 0x98, 0xB0, 0xC8, 0xE0, 0x50, 0x78, 0x00, 0x28, 0xF0, 0xD8, 0xA0, 0x88,
+	0xE8, 0xC0, 0xB8, 0x90, 0x48, 0x60, 0x18, 0x30, 0x80, 0xA8, 0xD0, 0xF8, 0x20, 0x08, 0x70, 0x58,
+	0xB0, 0x98, 0xE0, 0xC8, 0x10, 0x38, 0x40, 0x68, 0xD8, 0xF0, 0x88, 0xA0, 0x78, 0x50, 0x28, 0x00,
+	0x60, 0x48, 0x30, 0x18, 0xC0, 0xE8, 0x90, 0xB8, 0x08, 0x20, 0x58, 0x70, 0xA8, 0x80, 0xF8, 0xD0,
+	0x70, 0x58, 0x20, 0x08, 0xD0, 0xF8, 0x80, 0xA8, 0x18, 0x30, 0x48, 0x60, 0xB8, 0x90, 0xE8, 0xC0,
+	0xA0, 0x88, 0xF0, 0xD8, 0x00, 0x28, 0x50, 0x78, 0xC8, 0xE0, 0x98, 0xB0, 0x68, 0x40, 0x38, 0x10,
+	0xF8, 0xD0, 0xA8, 0x80, 0x58, 0x70, 0x08, 0x20, 0x90, 0xB8, 0xC0, 0xE8, 0x30, 0x18, 0x60, 0x48,
+	0x28, 0x00, 0x78, 0x50, 0x88, 0xA0, 0xD8, 0xF0, 0x40, 0x68, 0x10, 0x38, 0xE0, 0xC8, 0xB0, 0x98,
+	0x48, 0x60, 0x18, 0x30, 0xE8, 0xC0, 0xB8, 0x90, 0x20, 0x08, 0x70, 0x58, 0x80, 0xA8, 0xD0, 0xF8,
+	0x98, 0xB0, 0xC8, 0xE0, 0x38, 0x10, 0x68, 0x40, 0xF0, 0xD8, 0xA0, 0x88, 0x50, 0x78, 0x00, 0x28,
+	0xC0, 0xE8, 0x90, 0xB8, 0x60, 0x48, 0x30, 0x18, 0xA8, 0x80, 0xF8, 0xD0, 0x08, 0x20, 0x58, 0x70,
+	0x10, 0x38, 0x40, 0x68, 0xB0, 0x98, 0xE0, 0xC8, 0x78, 0x50, 0x28, 0x00, 0xD8, 0xF0, 0x88, 0xA0
+};
+
+uint8_t crc5_update(uint8_t crc, const uint8_t *data, uint16_t len)
+{
+    uint8_t state = crc << 3;
+
+    while (len--) {
+        state = crc5_table[state ^ *data++];
     }
 
-    return crc;
+    return state >> 3;
+}
+
+uint8_t crc5(uint8_t *data, uint8_t len)
+{
+    return crc5_update(CRC5_INIT, data, len);
 }
 
 // with loop unrolling
@@ -43,13 +59,16 @@ uint16_t crc16(uint8_t *data, uint16_t len)
     return crc;
 }
 
-uint16_t crc16_false(uint8_t *data, uint16_t len)
+uint16_t crc16_false_update(uint16_t crc, const uint8_t *data, uint16_t len)
 {
-    uint16_t crc = 0xFFFF;
-
     while(len--) {
         crc = crc16_table[(crc >> 8) ^ *data++] ^ (crc << 8);
     }
 
     return crc;
 }
+
+uint16_t crc16_false(uint8_t *data, uint16_t len)
+{
+    return crc16_false_update(CRC16_FALSE_INIT, data, len);
+}
@@ -1,5 +1,6 @@
 #include "frequency_transition_bmXX.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <math.h>
@@ -27,6 +28,7 @@ void do_frequency_transition(void * pvParameters, set_hash_frequency_fn set_freq
     }
 
     ESP_LOGI(TAG, "Ramping up frequency from %g MHz to %g MHz", current_frequency, target_frequency);
+    int64_t start_us = esp_timer_get_time();
 
     int current_step = (target_frequency > current_frequency) ? (int)floor(current_frequency / STEP_SIZE) : (int)ceil(current_frequency / STEP_SIZE);
     int target_step = (target_frequency > current_frequency) ? (int)floor(target_frequency / STEP_SIZE) : (int)ceil(target_frequency / STEP_SIZE);
@@ -50,5 +52,5 @@ void do_frequency_transition(void * pvParameters, set_hash_frequency_fn set_freq
         GLOBAL_STATE->POWER_MANAGEMENT_MODULE.actual_frequency = set_frequency_fn(current_frequency);
     }
     
-    ESP_LOGI(TAG, "Successfully transitioned to %g MHz", target_frequency);
+    ESP_LOGI(TAG, "Successfully transitioned to %g MHz in %lld ms", target_frequency, (esp_timer_get_time() - start_us) / 1000);
 }
@@ -13,6 +13,8 @@ void ASIC_set_version_mask(GlobalState * GLOBAL_STATE, uint32_t mask);
 void ASIC_set_frequency(GlobalState * GLOBAL_STATE);
 void ASIC_set_nonce_space(GlobalState * GLOBAL_STATE);
 double ASIC_get_asic_job_frequency_ms(GlobalState * GLOBAL_STATE);
+// Bit (1 << register_type) for every register ASIC_read_registers() requests
+uint16_t ASIC_read_register_mask(GlobalState * GLOBAL_STATE);
 void ASIC_read_registers(GlobalState * GLOBAL_STATE);
 
 #endif // ASIC_H
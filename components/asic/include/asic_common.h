@@ -7,6 +7,9 @@
 
 static const double NONCE_SPACE = 4294967296.0; //  2^32
 
+// Room for one broadcast read frame per monitored register
+#define REGISTER_READ_BURST_MAX (8 * 7)
+
 typedef enum
 {
     REGISTER_INVALID = 0,
@@ -24,6 +27,7 @@ typedef struct
 {
     // -- job result response
     uint8_t job_id;
+    uint32_t job_generation; // job_table generation of the slot the version was read from
     uint32_t nonce;
     uint32_t rolled_version;
     // ---- register response
@@ -43,7 +47,11 @@ void clear_asic_chain_error(void);
 const char *get_asic_chain_error(void);
 int count_asic_chips(uint16_t asic_count, uint16_t chip_id, int chip_id_response_length);
 esp_err_t receive_work(uint8_t * buffer, int buffer_size, uint64_t *out_timestamp_us);
+void clear_asic_rx(void);
+void get_asic_rx_stats(uint32_t *resyncs, uint32_t *bytes_skipped);
 void get_difficulty_mask(double difficulty, uint8_t *job_difficulty_mask);
+uint16_t register_read_mask(const register_type_t *register_map, int map_size);
+int build_register_read_burst(const register_type_t *register_map, int map_size, uint8_t header, uint8_t *burst, int burst_size);
 double calculate_bm_timeout_ms(float frequency_mhz, size_t asic_count, size_t small_cores, size_t cores, size_t version_size, float timeout_percent, double default_time_ms);
 
 #endif /* ASIC_COMMON_H_ */
@@ -0,0 +1,49 @@
+#ifndef ASIC_FRAMER_H_
+#define ASIC_FRAMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Large enough for a few of the biggest (11 byte) ASIC responses
+#define ASIC_FRAMER_BUFFER_SIZE 64
+// Reads tracked for timestamps; older ones are merged into the next when full
+#define ASIC_FRAMER_MAX_READS 8
+
+// Streaming parser for ASIC UART responses: 0xAA 0x55 followed by a payload
+// whose CRC5 (including the trailing crc bits) is zero. On a bad candidate it
+// drops one byte and tries again, so valid frames behind garbage are kept.
+typedef struct
+{
+    uint8_t buffer[ASIC_FRAMER_BUFFER_SIZE];
+    int length;
+    bool in_resync;
+
+    // Bytes before reads[i].end (and after reads[i - 1].end) arrived at reads[i].time_us
+    struct {
+        int end;
+        uint64_t time_us;
+    } reads[ASIC_FRAMER_MAX_READS];
+    int read_count;
+    uint64_t frame_time_us; // read that delivered the last byte of the last popped frame
+
+    uint32_t frames;        // valid frames returned
+    uint32_t resyncs;       // times the stream lost frame alignment
+    uint32_t bytes_skipped; // bytes dropped while realigning
+} asic_framer;
+
+void asic_framer_init(asic_framer *framer);
+
+// Drops any buffered bytes, e.g. after the UART lost data mid-stream; counters are kept
+void asic_framer_reset(asic_framer *framer);
+
+// Free space at the end of the buffer; at most this many bytes can be pushed
+int asic_framer_space(const asic_framer *framer);
+
+// Appends bytes received at time_us; returns how many were taken
+int asic_framer_push(asic_framer *framer, const uint8_t *data, int len, uint64_t time_us);
+
+// Copies the next valid frame of frame_size bytes into frame, removes it and sets
+// frame_time_us. Returns false when no complete frame is buffered yet.
+bool asic_framer_pop(asic_framer *framer, uint8_t *frame, int frame_size);
+
+#endif /* ASIC_FRAMER_H_ */
@@ -0,0 +1,58 @@
+#ifndef ASIC_INIT_SEQ_H_
+#define ASIC_INIT_SEQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// body[0] is replaced by the chip address passed to asic_init_steps()
+#define ASIC_INIT_PER_CHIP 0x01
+
+// Command frames carry at most a chip address, a register and a 32-bit value
+#define ASIC_INIT_MAX_BODY 6
+
+// One command of an init sequence, sent after everything before it and
+// followed by post_delay_ms of silence on the line
+typedef struct
+{
+    uint8_t header;
+    uint8_t flags;
+    uint8_t body[ASIC_INIT_MAX_BODY];
+    uint8_t body_len;
+    uint16_t post_delay_ms;
+} asic_init_step;
+
+#define ASIC_INIT_BODY_LEN(...) ((uint8_t)sizeof((uint8_t[]){ __VA_ARGS__ }))
+
+#define ASIC_INIT_CMD(hdr, ...) \
+    { .header = (hdr), .body = { __VA_ARGS__ }, .body_len = ASIC_INIT_BODY_LEN(__VA_ARGS__) }
+#define ASIC_INIT_CHIP_CMD(hdr, ...) \
+    { .header = (hdr), .flags = ASIC_INIT_PER_CHIP, .body = { __VA_ARGS__ }, .body_len = ASIC_INIT_BODY_LEN(__VA_ARGS__) }
+#define ASIC_INIT_CHIP_CMD_DELAY(delay_ms, hdr, ...) \
+    { .header = (hdr), .flags = ASIC_INIT_PER_CHIP, .body = { __VA_ARGS__ }, .body_len = ASIC_INIT_BODY_LEN(__VA_ARGS__), .post_delay_ms = (delay_ms) }
+
+#define ASIC_INIT_STEP_COUNT(steps) ((int)(sizeof(steps) / sizeof((steps)[0])))
+
+#define ASIC_INIT_BUFFER_SIZE 256
+
+// Buffered writer for one phase of chip init: frames are queued and go out
+// as a single UART write whenever a delay is due, the buffer fills or the
+// phase ends. The phase's duration and write count are logged at the end.
+typedef struct
+{
+    const char *phase;
+    int64_t start_us;
+    uint8_t buffer[ASIC_INIT_BUFFER_SIZE];
+    int length;
+    int frames;
+    int writes;
+    uint32_t delay_ms;
+    bool debug;
+} asic_init_batch;
+
+void asic_init_begin(asic_init_batch *batch, const char *phase, bool debug);
+void asic_init_add(asic_init_batch *batch, uint8_t header, const uint8_t *body, uint8_t body_len);
+void asic_init_steps(asic_init_batch *batch, const asic_init_step *steps, int count, uint8_t chip_address);
+void asic_init_delay(asic_init_batch *batch, uint32_t delay_ms);
+void asic_init_end(asic_init_batch *batch);
+
+#endif /* ASIC_INIT_SEQ_H_ */
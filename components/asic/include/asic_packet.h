@@ -0,0 +1,37 @@
+#ifndef ASIC_PACKET_H_
+#define ASIC_PACKET_H_
+
+#include <stdint.h>
+
+#define ASIC_PACKET_TYPE_JOB 0x20
+
+// Largest body sent to any ASIC (BM1397 job with 4 midstates)
+#define ASIC_PACKET_MAX_BODY 146
+// 0x55 0xAA, header, length, body, crc16 for jobs or crc5 for commands
+#define ASIC_PACKET_LEN(header, body_len) ((body_len) + (((header) & ASIC_PACKET_TYPE_JOB) ? 6 : 5))
+#define ASIC_PACKET_MAX_LEN ASIC_PACKET_LEN(ASIC_PACKET_TYPE_JOB, ASIC_PACKET_MAX_BODY)
+
+// Assembles a complete frame into packet, which must hold ASIC_PACKET_LEN(header, body_len) bytes.
+// Returns the frame length.
+int asic_packet_build(uint8_t *packet, uint8_t header, const uint8_t *body, uint8_t body_len);
+
+// A frame whose preamble, header and length are written once; callers patch
+// the body in place and seal it, which only runs the crc over the body.
+typedef struct
+{
+    uint8_t frame[ASIC_PACKET_MAX_LEN];
+    uint8_t body_len;
+    uint16_t prefix_crc; // crc state after the header and length bytes
+} asic_packet_template;
+
+void asic_packet_template_init(asic_packet_template *packet, uint8_t header, uint8_t body_len);
+
+static inline uint8_t *asic_packet_template_body(asic_packet_template *packet)
+{
+    return packet->frame + 4;
+}
+
+// Writes the crc for the current body and returns the frame length
+int asic_packet_template_seal(asic_packet_template *packet);
+
+#endif /* ASIC_PACKET_H_ */
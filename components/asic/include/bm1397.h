@@ -30,6 +30,7 @@ int BM1397_set_max_baud(void);
 int BM1397_set_default_baud(void);
 float BM1397_send_hash_frequency(float frequency);
 task_result * BM1397_process_work(void * GLOBAL_STATE);
+uint16_t BM1397_read_register_mask(void);
 void BM1397_read_registers(void);
 
 #endif /* BM1397_H_ */
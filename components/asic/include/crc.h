@@ -38,9 +38,16 @@ static const uint16_t crc16_table[256] = {
 	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
 };
 
+#define CRC5_INIT 0x1F
+#define CRC16_FALSE_INIT 0xFFFF
+
 uint8_t crc5(uint8_t *data, uint8_t len);
 uint16_t crc16(uint8_t *data, uint16_t len);
 uint16_t crc16_false(uint8_t *data, uint16_t len);
 
+// Continue a crc over more data; start from CRC5_INIT / CRC16_FALSE_INIT
+uint8_t crc5_update(uint8_t crc, const uint8_t *data, uint16_t len);
+uint16_t crc16_false_update(uint16_t crc, const uint8_t *data, uint16_t len);
+
 
 #endif /* INC_CRC_H_ */
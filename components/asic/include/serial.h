@@ -15,6 +15,11 @@ int SERIAL_send(uint8_t *, int, bool);
 esp_err_t SERIAL_init(void);
 void SERIAL_debug_rx(void);
 int16_t SERIAL_rx(uint8_t *, uint16_t, uint16_t);
+int16_t SERIAL_rx_available(uint8_t *, uint16_t, uint16_t);
+esp_err_t SERIAL_set_rx_threshold(int bytes);
+uint32_t SERIAL_rx_wakeups(void);
+uint32_t SERIAL_rx_overflows(void);
+uint32_t SERIAL_rx_buffer_full(void);
 void SERIAL_clear_buffer(void);
 esp_err_t SERIAL_set_baud(int baud);
 bool SERIAL_is_initialized(void);
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 
 #include "driver/uart.h"
 
@@ -15,9 +16,18 @@
 #define ECHO_TEST_TXD (17)
 #define ECHO_TEST_RXD (18)
 #define BUF_SIZE (1024)
+#define EVENT_QUEUE_SIZE (32)
+
+// Idle time, in symbols, after which the driver reports a partial FIFO
+#define RX_TIMEOUT_SYMBOLS (4)
 
 static const char *TAG = "serial";
 
+static QueueHandle_t uart_queue;
+static uint32_t rx_wakeups;
+static uint32_t rx_overflows;
+static uint32_t rx_buffer_full;
+
 esp_err_t SERIAL_init(void)
 {
     ESP_LOGI(TAG, "Initializing serial");
@@ -35,10 +45,14 @@ esp_err_t SERIAL_init(void)
     // Set UART1 pins(TX: IO17, RX: I018)
     ESP_ERROR_CHECK_WITHOUT_ABORT(uart_set_pin(UART_NUM_1, ECHO_TEST_TXD, ECHO_TEST_RXD, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
 
-    // Install UART driver (we don't need an event queue here)
+    // Install UART driver with an event queue so the result path can sleep until data arrives
     // tx buffer 0 so the tx time doesn't overlap with the job wait time
     //  by returning before the job is written
-    return uart_driver_install(UART_NUM_1, BUF_SIZE * 2, BUF_SIZE * 2, 0, NULL, 0);
+    esp_err_t err = uart_driver_install(UART_NUM_1, BUF_SIZE * 2, BUF_SIZE * 2, EVENT_QUEUE_SIZE, &uart_queue, 0);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return uart_set_rx_timeout(UART_NUM_1, RX_TIMEOUT_SYMBOLS);
 }
 
 bool SERIAL_is_initialized(void)
@@ -91,6 +105,82 @@ int16_t SERIAL_rx(uint8_t *buf, uint16_t size, uint16_t timeout_ms)
     return bytes_read;
 }
 
+// Returns true if the event means received bytes were lost
+static bool handle_rx_event(const uart_event_t *event)
+{
+    switch (event->type) {
+        case UART_FIFO_OVF:
+            // The driver reset the hardware FIFO; what is already in the ring buffer is intact
+            ESP_LOGW(TAG, "RX FIFO overflow, bytes lost");
+            rx_overflows++;
+            return true;
+        case UART_BUFFER_FULL:
+            // Nothing is lost yet, the driver stops moving bytes out of the FIFO until the ring is drained
+            rx_buffer_full++;
+            return false;
+        default:
+            // UART_DATA, or an event left over from blocking reads; the buffer is rechecked either way
+            return false;
+    }
+}
+
+/// @brief waits for the UART driver to report received data, then reads what is buffered without blocking
+/// @param buf buffer to read data into
+/// @param size maximum number of bytes to read
+/// @param timeout_ms number of ms to wait for data before timing out
+/// @return number of bytes read, 0 on timeout, or -1 if the UART dropped bytes since the last call
+///         (buffered data is kept, but a response in progress may be missing bytes)
+int16_t SERIAL_rx_available(uint8_t *buf, uint16_t size, uint16_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    bool lost = false;
+    uart_event_t event;
+
+    // Events queued while we were busy, so an overflow is reported before the bytes behind it are read
+    while (xQueueReceive(uart_queue, &event, 0) == pdTRUE) {
+        lost |= handle_rx_event(&event);
+    }
+
+    size_t buffered = 0;
+    uart_get_buffered_data_len(UART_NUM_1, &buffered);
+    while (buffered == 0 && !lost) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout || xQueueReceive(uart_queue, &event, timeout - elapsed) != pdTRUE) {
+            return 0;
+        }
+        rx_wakeups++;
+        lost = handle_rx_event(&event);
+        uart_get_buffered_data_len(UART_NUM_1, &buffered);
+    }
+
+    if (lost) {
+        return -1;
+    }
+
+    return SERIAL_rx(buf, buffered < size ? buffered : size, 0);
+}
+
+esp_err_t SERIAL_set_rx_threshold(int bytes)
+{
+    return uart_set_rx_full_threshold(UART_NUM_1, bytes);
+}
+
+uint32_t SERIAL_rx_wakeups(void)
+{
+    return rx_wakeups;
+}
+
+uint32_t SERIAL_rx_overflows(void)
+{
+    return rx_overflows;
+}
+
+uint32_t SERIAL_rx_buffer_full(void)
+{
+    return rx_buffer_full;
+}
+
 void SERIAL_debug_rx(void)
 {
     int ret;
@@ -109,4 +199,7 @@ void SERIAL_debug_rx(void)
 void SERIAL_clear_buffer(void)
 {
     uart_flush(UART_NUM_1);
+    if (uart_queue != NULL) {
+        xQueueReset(uart_queue);
+    }
 }
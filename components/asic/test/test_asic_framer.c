@@ -0,0 +1,228 @@
+#include "unity.h"
+
+#include "asic_framer.h"
+#include "crc.h"
+
+#include <string.h>
+
+#define FRAME_SIZE 11
+
+// BM1366-style nonce response with the crc bits of the last byte filled in
+static void make_frame(uint8_t *frame, uint8_t seed)
+{
+    frame[0] = 0xAA;
+    frame[1] = 0x55;
+    for (int i = 2; i < FRAME_SIZE; i++) {
+        frame[i] = (uint8_t)(seed * 13 + i * 7);
+    }
+    frame[FRAME_SIZE - 1] = 0x80;
+    for (uint8_t crc = 0; crc < 32; crc++) {
+        frame[FRAME_SIZE - 1] = 0x80 | crc;
+        if (crc5(frame + 2, FRAME_SIZE - 2) == 0) return;
+    }
+    TEST_FAIL_MESSAGE("no crc5 value validates the frame");
+}
+
+static void push_all(asic_framer *framer, const uint8_t *data, int len)
+{
+    TEST_ASSERT_EQUAL_INT(len, asic_framer_push(framer, data, len, 0));
+}
+
+TEST_CASE("Framer returns back to back frames", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t stream[3 * FRAME_SIZE];
+    for (int i = 0; i < 3; i++) {
+        make_frame(stream + i * FRAME_SIZE, i);
+    }
+    push_all(&framer, stream, sizeof(stream));
+
+    uint8_t frame[FRAME_SIZE];
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(stream + i * FRAME_SIZE, frame, FRAME_SIZE);
+    }
+    TEST_ASSERT_FALSE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(3, framer.frames);
+    TEST_ASSERT_EQUAL_UINT32(0, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(0, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer waits for a frame split across reads", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t expected[FRAME_SIZE];
+    make_frame(expected, 1);
+
+    uint8_t frame[FRAME_SIZE];
+    push_all(&framer, expected, 4);
+    TEST_ASSERT_FALSE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+
+    push_all(&framer, expected + 4, FRAME_SIZE - 4);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(0, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer skips leading garbage and keeps later frames", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t stream[5 + 2 * FRAME_SIZE] = { 0x00, 0xAA, 0x13, 0x55, 0xFF };
+    make_frame(stream + 5, 2);
+    make_frame(stream + 5 + FRAME_SIZE, 3);
+    push_all(&framer, stream, sizeof(stream));
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream + 5, frame, FRAME_SIZE);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream + 5 + FRAME_SIZE, frame, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(5, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer resyncs past a truncated frame", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    // A frame cut short by a dropped byte, immediately followed by two good ones
+    uint8_t good[2][FRAME_SIZE];
+    make_frame(good[0], 4);
+    make_frame(good[1], 5);
+    uint8_t truncated[FRAME_SIZE];
+    make_frame(truncated, 6);
+
+    push_all(&framer, truncated, FRAME_SIZE - 3);
+    push_all(&framer, good[0], FRAME_SIZE);
+    push_all(&framer, good[1], FRAME_SIZE);
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(good[0], frame, FRAME_SIZE);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(good[1], frame, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_SIZE - 3, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer drops a frame with a corrupted crc", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t bad[FRAME_SIZE];
+    uint8_t good[FRAME_SIZE];
+    make_frame(bad, 7);
+    make_frame(good, 8);
+    bad[6] ^= 0x04;
+
+    push_all(&framer, bad, FRAME_SIZE);
+    push_all(&framer, good, FRAME_SIZE);
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(good, frame, FRAME_SIZE);
+    TEST_ASSERT_FALSE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(1, framer.frames);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(FRAME_SIZE, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer counts separate resync events", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t good[FRAME_SIZE];
+    make_frame(good, 9);
+    uint8_t noise[2] = { 0x12, 0x34 };
+
+    uint8_t frame[FRAME_SIZE];
+    for (int i = 0; i < 3; i++) {
+        push_all(&framer, noise, sizeof(noise));
+        push_all(&framer, good, FRAME_SIZE);
+        TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(6, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer only takes what fits", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t noise[ASIC_FRAMER_BUFFER_SIZE + 8];
+    memset(noise, 0x11, sizeof(noise));
+    TEST_ASSERT_EQUAL_INT(ASIC_FRAMER_BUFFER_SIZE, asic_framer_push(&framer, noise, sizeof(noise), 0));
+    TEST_ASSERT_EQUAL_INT(0, asic_framer_space(&framer));
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_FALSE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_INT(ASIC_FRAMER_BUFFER_SIZE, asic_framer_space(&framer));
+    TEST_ASSERT_EQUAL_UINT32(ASIC_FRAMER_BUFFER_SIZE, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer reset drops a partial frame but keeps counters", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t good[FRAME_SIZE];
+    make_frame(good, 5);
+    uint8_t noise[1] = { 0x77 };
+    push_all(&framer, noise, sizeof(noise));
+    push_all(&framer, good, FRAME_SIZE);
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+
+    // Half a response, then the rest is lost on the wire
+    push_all(&framer, good, FRAME_SIZE / 2);
+    asic_framer_reset(&framer);
+    TEST_ASSERT_EQUAL_INT(ASIC_FRAMER_BUFFER_SIZE, asic_framer_space(&framer));
+
+    push_all(&framer, good, FRAME_SIZE);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(good, frame, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.bytes_skipped);
+}
+
+TEST_CASE("Framer stamps each frame with the read that completed it", "[framer]")
+{
+    asic_framer framer;
+    asic_framer_init(&framer);
+
+    uint8_t frames[3][FRAME_SIZE];
+    for (int i = 0; i < 3; i++) {
+        make_frame(frames[i], i);
+    }
+
+    // Read at 100: frame 0 and the first half of frame 1
+    asic_framer_push(&framer, frames[0], FRAME_SIZE, 100);
+    asic_framer_push(&framer, frames[1], FRAME_SIZE / 2, 100);
+    // Read at 200: the rest of frame 1 and all of frame 2
+    asic_framer_push(&framer, frames[1] + FRAME_SIZE / 2, FRAME_SIZE - FRAME_SIZE / 2, 200);
+    asic_framer_push(&framer, frames[2], FRAME_SIZE, 200);
+
+    uint8_t frame[FRAME_SIZE];
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(100, (uint32_t)framer.frame_time_us);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(200, (uint32_t)framer.frame_time_us);
+
+    // A later read does not restamp a frame that was already buffered
+    uint8_t noise[2] = { 0x12, 0x34 };
+    asic_framer_push(&framer, noise, sizeof(noise), 300);
+    TEST_ASSERT_TRUE(asic_framer_pop(&framer, frame, FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frames[2], frame, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(200, (uint32_t)framer.frame_time_us);
+}
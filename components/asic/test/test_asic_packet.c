@@ -0,0 +1,191 @@
+#include "unity.h"
+
+#include "asic_common.h"
+#include "asic_init_seq.h"
+#include "asic_packet.h"
+#include "crc.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TYPE_JOB 0x20
+#define TYPE_CMD 0x40
+#define GROUP_SINGLE 0x00
+#define GROUP_ALL 0x10
+#define CMD_WRITE 0x01
+#define CMD_READ 0x02
+
+// The bit-by-bit crc5 the table replaced
+static uint8_t reference_crc5(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0x1F;
+    for (uint8_t byte_counter = 0; byte_counter < len; byte_counter++) {
+        uint8_t byte = data[byte_counter];
+        for (uint8_t bit_counter = 0; bit_counter < 8; bit_counter++) {
+            uint8_t bit = (byte >> 7) & 1;
+            byte <<= 1;
+            uint8_t new_bit = ((crc >> 4) ^ bit) & 1;
+            crc = ((crc << 1) | new_bit) ^ (new_bit << 2);
+            crc &= 0x1F;
+        }
+    }
+    return crc;
+}
+
+// The frame assembly the drivers used before asic_packet_build()
+static int reference_packet(uint8_t *buf, uint8_t header, const uint8_t *data, uint8_t data_len)
+{
+    bool is_job = header & TYPE_JOB;
+    buf[0] = 0x55;
+    buf[1] = 0xAA;
+    buf[2] = header;
+    buf[3] = is_job ? (data_len + 4) : (data_len + 3);
+    memcpy(buf + 4, data, data_len);
+    if (is_job) {
+        uint16_t crc16_total = crc16_false(buf + 2, data_len + 2);
+        buf[4 + data_len] = (crc16_total >> 8) & 0xFF;
+        buf[5 + data_len] = crc16_total & 0xFF;
+        return data_len + 6;
+    }
+    buf[4 + data_len] = reference_crc5(buf + 2, data_len + 2);
+    return data_len + 5;
+}
+
+static void fill_random(uint8_t *buf, int len)
+{
+    for (int i = 0; i < len; i++) {
+        buf[i] = rand() & 0xFF;
+    }
+}
+
+TEST_CASE("crc5 matches the bitwise implementation", "[crc]")
+{
+    uint8_t data[64];
+    srand(5);
+    for (int i = 0; i < 500; i++) {
+        uint8_t len = rand() % sizeof(data);
+        fill_random(data, len);
+        TEST_ASSERT_EQUAL_UINT8(reference_crc5(data, len), crc5(data, len));
+    }
+}
+
+TEST_CASE("crc5 of a known command frame", "[crc]")
+{
+    // Chain inactive, as sent during BM1370 init
+    uint8_t cmd[] = {0x53, 0x05, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_UINT8(0x03, crc5(cmd, sizeof(cmd)));
+    TEST_ASSERT_EQUAL_UINT8(reference_crc5(cmd, sizeof(cmd)), crc5(cmd, sizeof(cmd)));
+}
+
+TEST_CASE("crc updates can be split anywhere", "[crc]")
+{
+    uint8_t data[100];
+    srand(7);
+    fill_random(data, sizeof(data));
+    for (int split = 0; split <= (int)sizeof(data); split += 9) {
+        uint8_t c5 = crc5_update(crc5_update(CRC5_INIT, data, split), data + split, sizeof(data) - split);
+        TEST_ASSERT_EQUAL_UINT8(crc5(data, sizeof(data)), c5);
+        uint16_t c16 = crc16_false_update(crc16_false_update(CRC16_FALSE_INIT, data, split), data + split, sizeof(data) - split);
+        TEST_ASSERT_EQUAL_UINT16(crc16_false(data, sizeof(data)), c16);
+    }
+}
+
+TEST_CASE("asic_packet_build matches the old frame assembly", "[packet]")
+{
+    const uint8_t headers[] = {
+        TYPE_CMD | GROUP_ALL | CMD_WRITE,
+        TYPE_CMD | GROUP_SINGLE | CMD_WRITE,
+        TYPE_CMD | GROUP_ALL | CMD_READ,
+        TYPE_JOB | GROUP_SINGLE | CMD_WRITE,
+    };
+    const uint8_t lengths[] = {2, 6, 82, ASIC_PACKET_MAX_BODY};
+    uint8_t body[ASIC_PACKET_MAX_BODY];
+    uint8_t expected[ASIC_PACKET_MAX_LEN];
+    uint8_t packet[ASIC_PACKET_MAX_LEN];
+
+    srand(11);
+    for (int h = 0; h < (int)sizeof(headers); h++) {
+        for (int l = 0; l < (int)sizeof(lengths); l++) {
+            fill_random(body, lengths[l]);
+            int expected_len = reference_packet(expected, headers[h], body, lengths[l]);
+            int len = asic_packet_build(packet, headers[h], body, lengths[l]);
+            TEST_ASSERT_EQUAL_INT(expected_len, len);
+            TEST_ASSERT_EQUAL_INT(ASIC_PACKET_LEN(headers[h], lengths[l]), len);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, packet, len);
+        }
+    }
+}
+
+TEST_CASE("Packet templates match the old frame assembly after each patch", "[packet]")
+{
+    asic_packet_template job;
+    asic_packet_template_init(&job, TYPE_JOB | GROUP_SINGLE | CMD_WRITE, 82);
+    asic_packet_template cmd;
+    asic_packet_template_init(&cmd, TYPE_CMD | GROUP_ALL | CMD_WRITE, 6);
+
+    uint8_t expected[ASIC_PACKET_MAX_LEN];
+    srand(13);
+    for (int i = 0; i < 20; i++) {
+        // Patch only some fields, like send_work does
+        uint8_t *body = asic_packet_template_body(&job);
+        body[0] = i * 24 % 128;
+        fill_random(body + 2, 12);
+        if (i % 4 == 0) fill_random(body + 14, 68);
+
+        int len = asic_packet_template_seal(&job);
+        TEST_ASSERT_EQUAL_INT(reference_packet(expected, TYPE_JOB | GROUP_SINGLE | CMD_WRITE, body, 82), len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, job.frame, len);
+
+        body = asic_packet_template_body(&cmd);
+        fill_random(body, 6);
+        len = asic_packet_template_seal(&cmd);
+        TEST_ASSERT_EQUAL_INT(reference_packet(expected, TYPE_CMD | GROUP_ALL | CMD_WRITE, body, 6), len);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, cmd.frame, len);
+    }
+}
+
+TEST_CASE("Register read burst holds one read frame per mapped register", "[packet]")
+{
+    static const register_type_t register_map[] = {
+        [0x4C] = REGISTER_ERROR_COUNT,
+        [0x8C] = REGISTER_TOTAL_COUNT,
+    };
+    const uint8_t header = TYPE_CMD | GROUP_ALL | CMD_READ;
+
+    uint8_t burst[REGISTER_READ_BURST_MAX];
+    int len = build_register_read_burst(register_map, sizeof(register_map) / sizeof(register_map[0]), header, burst, sizeof(burst));
+
+    uint8_t expected[2 * ASIC_PACKET_LEN(TYPE_CMD, 2)];
+    int expected_len = reference_packet(expected, header, (uint8_t[]){0x00, 0x4C}, 2);
+    expected_len += reference_packet(expected + expected_len, header, (uint8_t[]){0x00, 0x8C}, 2);
+
+    TEST_ASSERT_EQUAL_INT(expected_len, len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, burst, len);
+    TEST_ASSERT_EQUAL_UINT16((1 << REGISTER_ERROR_COUNT) | (1 << REGISTER_TOTAL_COUNT),
+                             register_read_mask(register_map, sizeof(register_map) / sizeof(register_map[0])));
+}
+
+TEST_CASE("Init steps queue frames back to back with the chip address filled in", "[packet]")
+{
+    static const asic_init_step steps[] = {
+        ASIC_INIT_CMD(TYPE_CMD | GROUP_ALL | CMD_WRITE, 0x00, 0xA8, 0x00, 0x07, 0x00, 0x00),
+        ASIC_INIT_CHIP_CMD(TYPE_CMD | GROUP_SINGLE | CMD_WRITE, 0x00, 0x3C, 0x80, 0x00, 0x82, 0xAA),
+    };
+
+    // Nothing is sent until a delay, a full buffer or asic_init_end()
+    asic_init_batch batch;
+    asic_init_begin(&batch, "test", false);
+    asic_init_steps(&batch, steps, ASIC_INIT_STEP_COUNT(steps), 0x40);
+    asic_init_add(&batch, TYPE_CMD | GROUP_ALL | CMD_READ, (uint8_t[]){0x00, 0x00}, 2);
+
+    uint8_t expected[3 * ASIC_PACKET_LEN(TYPE_CMD, 6)];
+    int expected_len = reference_packet(expected, TYPE_CMD | GROUP_ALL | CMD_WRITE, (uint8_t[]){0x00, 0xA8, 0x00, 0x07, 0x00, 0x00}, 6);
+    expected_len += reference_packet(expected + expected_len, TYPE_CMD | GROUP_SINGLE | CMD_WRITE, (uint8_t[]){0x40, 0x3C, 0x80, 0x00, 0x82, 0xAA}, 6);
+    expected_len += reference_packet(expected + expected_len, TYPE_CMD | GROUP_ALL | CMD_READ, (uint8_t[]){0x00, 0x00}, 2);
+
+    TEST_ASSERT_EQUAL_INT(3, batch.frames);
+    TEST_ASSERT_EQUAL_INT(0, batch.writes);
+    TEST_ASSERT_EQUAL_INT(expected_len, batch.length);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, batch.buffer, expected_len);
+}
@@ -0,0 +1,49 @@
+#ifndef JOB_TABLE_H_
+#define JOB_TABLE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "mining.h"
+
+// Jobs sent to the ASICs, indexed by the 7-bit job id the chips echo back with
+// every nonce. Each slot carries a sequence counter (seqlock): the job sender
+// makes it odd while rewriting the slot and even again when done, and readers
+// copy what they need and check the counter did not move. Readers never block
+// the sender and nothing is allocated on either side.
+//
+// A slot has a single writer (the task calling ASIC_send_work); readers may run
+// on any task or core.
+
+typedef struct
+{
+    atomic_uint seq;  // odd while the slot is being rewritten
+    uint32_t epoch;   // table epoch the job was published under
+    bm_job job;
+} job_slot;
+
+typedef struct
+{
+    job_slot *slots;  // BM_JOB_POOL_SIZE entries
+    atomic_uint epoch; // bumped to invalidate every slot at once
+} job_table;
+
+// slots must hold BM_JOB_POOL_SIZE zeroed entries
+void job_table_init(job_table *table, job_slot *slots);
+
+// Copy job into slot id and mark it valid
+void job_table_publish(job_table *table, uint8_t id, const bm_job *job);
+
+// Invalidate every slot (clean jobs); jobs published afterwards are valid
+void job_table_invalidate_all(job_table *table);
+
+// Read the version fields of slot id. generation identifies this publication of
+// the slot for a later job_table_read(). Returns false if the slot holds no valid job.
+bool job_table_read_version(job_table *table, uint8_t id, uint32_t *version, uint32_t *version_mask,
+                            uint32_t *generation);
+
+// Copy slot id into out. Returns false if the slot is invalid or has been
+// rewritten since generation was read, i.e. the job the nonce belongs to is gone.
+bool job_table_read(job_table *table, uint8_t id, uint32_t generation, bm_job *out);
+
+#endif // JOB_TABLE_H_
@@ -0,0 +1,31 @@
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+
+// Log-bucketed latency histogram over microseconds. Each power of two is split
+// into LATENCY_HISTOGRAM_SUB_BUCKETS linear buckets, so a percentile is off by
+// at most 1/LATENCY_HISTOGRAM_SUB_BUCKETS of its value. Samples from 1 us up to
+// ~67 s fit; longer ones are counted in the last bucket.
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 2
+#define LATENCY_HISTOGRAM_SUB_BUCKETS (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_MAX_EXPONENT 26
+#define LATENCY_HISTOGRAM_BUCKETS ((LATENCY_HISTOGRAM_MAX_EXPONENT - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 2) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct
+{
+    uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} latency_histogram;
+
+void latency_histogram_reset(latency_histogram *histogram);
+
+void latency_histogram_record(latency_histogram *histogram, uint32_t latency_us);
+
+// Upper edge of the bucket holding the given percentile (0-100), capped at the
+// largest sample. 0 while the histogram is empty.
+uint32_t latency_histogram_percentile(const latency_histogram *histogram, float percentile);
+
+#endif // LATENCY_HISTOGRAM_H_
@@ -2,6 +2,12 @@
 #define MINING_H_
 
 #include "stratum_api.h"
+#include "mbedtls/sha256.h"
+
+// Job ids are 7 bits wide on every supported ASIC
+#define BM_JOB_POOL_SIZE 128
+#define BM_JOB_ID_SIZE 64
+#define BM_JOB_EXTRANONCE2_SIZE 65 // up to 32 bytes of extranonce_2, hex encoded
 
 typedef struct
 {
@@ -19,32 +25,95 @@ typedef struct
     uint8_t midstate2[32];
     uint8_t midstate3[32];
     double pool_diff;
-    char *jobid;
-    char *extranonce2;
+    char jobid[BM_JOB_ID_SIZE];
+    char extranonce2[BM_JOB_EXTRANONCE2_SIZE];
 } bm_job;
 
-void free_bm_job(bm_job *job);
+// Binary coinbase transaction for one notify:
+// prefix | extranonce_prefix | extranonce_2 | suffix
+// Built once per notify, each new extranonce_2 is patched in place before hashing.
+// prefix_ctx holds the SHA-256 state after all complete 64-byte blocks in front of
+// extranonce_2, so only the tail from prefix_hashed onwards is hashed per job.
+typedef struct
+{
+    uint8_t *tx;
+    size_t tx_len;
+    size_t extranonce_2_offset;
+    size_t extranonce_2_len;
+    size_t prefix_hashed;
+    mbedtls_sha256_context prefix_ctx;
+} coinbase_template;
+
+bool coinbase_template_init(coinbase_template *tmpl, const uint8_t *prefix, size_t prefix_len,
+                            const uint8_t *extranonce_prefix, size_t ep_len, size_t e2_len,
+                            const uint8_t *suffix, size_t suffix_len);
+
+void coinbase_template_free(coinbase_template *tmpl);
+
+void calculate_coinbase_tx_hash_template(coinbase_template *tmpl, const uint8_t *extranonce_2, uint8_t dest[32]);
 
 void calculate_coinbase_tx_hash(const char *coinbase_1, const char *coinbase_2,
                                 const char *extranonce, const char *extranonce_2, uint8_t dest[32]);
 
-void calculate_coinbase_tx_hash_bin(const uint8_t *prefix, size_t prefix_len,
-                                    const uint8_t *extranonce_prefix, size_t ep_len,
-                                    const uint8_t *extranonce_2, size_t e2_len,
-                                    const uint8_t *suffix, size_t suffix_len,
-                                    uint8_t dest[32]);
-
 void calculate_merkle_root_hash(const uint8_t coinbase_tx_hash[32], const uint8_t merkle_branches[][32], const int num_merkle_branches, uint8_t dest[32]);
 
+// Rolled midstates of a 64-byte header block, see sha256_midstates_64_rolled(). With split,
+// half of them are computed on the other core through work_split_run(); the result is the same.
+void calculate_rolled_midstates(const uint8_t header[64], const uint32_t *versions, int count, uint8_t *const dest[], bool split);
+
+// Decode a mining.notify prev_block_hash into block header byte order and bm_job (ASIC) order
+void decode_prev_block_hash(const char *prev_block_hash, uint8_t header_order[32], uint8_t asic_order[32]);
+
+// Fill the header fields, ASIC-order merkle_root/prev_block_hash and all rolled midstates
+// of a job. prev_block_hash and merkle_root are in block header byte order.
+void construct_bm_job_header(uint32_t version, const uint8_t prev_block_hash[32], const uint8_t merkle_root[32],
+                             uint32_t ntime, uint32_t nbits, uint32_t version_mask, double difficulty, bm_job *new_job);
+
+// Uses the prev_block_hash decoded into params by decode_prev_block_hash()
 void construct_bm_job(mining_notify *params, const uint8_t merkle_root[32], const uint32_t version_mask, const double difficulty, bm_job* new_job);
 
+// Full job builders for each work source, shared by create_jobs_task and the host benchmarks.
+// The V1 job id must fit in BM_JOB_ID_SIZE; notifies with longer ids are rejected
+// (create_jobs_task does so before building any job), never shortened.
+void construct_bm_job_v1(mining_notify *notification, coinbase_template *tmpl, uint64_t extranonce_2,
+                         uint32_t version_mask, double difficulty, bm_job *job);
+
+void construct_bm_job_sv2(uint32_t job_id, uint32_t version, const uint8_t merkle_root[32], const uint8_t prev_hash[32],
+                          uint32_t ntime, uint32_t nbits, uint32_t version_mask, double difficulty, bm_job *job);
+
+void construct_bm_job_sv2_ext(uint32_t job_id, uint32_t version, const uint8_t prev_hash[32], uint32_t ntime, uint32_t nbits,
+                              const uint8_t merkle_path[][32], int merkle_path_count, coinbase_template *tmpl,
+                              uint64_t extranonce_2, uint32_t version_mask, double difficulty, bm_job *job);
+
 // Convert a 256-bit value (block hash or pool target, little-endian) to
 // difficulty (pdiff = truediffone / value). Shared by SV1 (test_nonce_value)
 // and SV2 (target). Returns a double to preserve fractional difficulty.
 double hash_to_pdiff(const uint8_t hash[32]);
 
+// Inverse of hash_to_pdiff(): the little-endian target of a difficulty.
+// A difficulty of 0 or less gives the largest possible target.
+void pdiff_to_target(double difficulty, uint8_t target[32]);
+
+// Difficulty at which hashrate_ghs finds shares_per_minute shares on average
+double difficulty_for_share_rate(float hashrate_ghs, float shares_per_minute);
+
+// Seconds a rolled ntime may lead the pool's clock: the notify ntime plus the
+// time since it arrived. Covers network delay and the pool's whole-second ntime.
+#define NTIME_ROLL_ALLOWANCE_S 5
+
+// Highest ntime a job rolled from notify_ntime may carry at now_us
+uint32_t ntime_roll_limit(uint32_t notify_ntime, int64_t received_time_us, int64_t now_us);
+
+// Difficulty of the header hash for nonce/rolled_version. Resumes from the job's
+// midstate when rolled_version is one the job was built with.
 double test_nonce_value(const bm_job *job, const uint32_t nonce, const uint32_t rolled_version);
 
+// Same as test_nonce_value(), but returns 0 without the 256-bit conversion when
+// the top hash word already shows the difficulty is below min_diff
+double test_nonce_value_min(const bm_job *job, const uint32_t nonce, const uint32_t rolled_version, const double min_diff);
+
+void extranonce_2_generate_bin(uint64_t extranonce_2, uint32_t length, uint8_t dest[static length]);
+
 void extranonce_2_generate(uint64_t extranonce_2, uint32_t length, char dest[static length * 2 + 1]);
 
 uint32_t increment_bitmask(const uint32_t value, const uint32_t mask);
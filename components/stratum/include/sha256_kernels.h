@@ -0,0 +1,30 @@
+#ifndef SHA256_KERNELS_H_
+#define SHA256_KERNELS_H_
+
+#include <stdint.h>
+
+// Fixed-length SHA-256 for the three shapes mining hashes over and over:
+// 80-byte block headers, 64-byte merkle node pairs and 64-byte midstates.
+// The software path uses unrolled rounds and precomputed padding blocks;
+// CONFIG_STRATUM_SHA256_HW routes them through mbedtls (SHA peripheral) instead.
+
+// dest = SHA256(SHA256(data[0..80])), same byte order as mbedtls_sha256()
+void sha256d_80(const uint8_t data[80], uint8_t dest[32]);
+
+// dest = SHA256(SHA256(data[0..64])), same byte order as mbedtls_sha256()
+void sha256d_64(const uint8_t data[64], uint8_t dest[32]);
+
+// SHA-256 state after the first 64-byte block, each state word big-endian
+// (the layout of mbedtls_sha256_context.state with the SHA peripheral)
+void sha256_midstate_64(const uint8_t data[64], uint8_t dest[32]);
+
+// Midstates of data[64] with its first word replaced by each of versions[0..count)
+// (stored in host byte order, like bm_job.version), written straight into dest[i]
+// in ASIC job order: reverse_32bit_words() of what sha256_midstate_64() returns.
+void sha256_midstates_64_rolled(const uint8_t data[64], const uint32_t *versions, int count, uint8_t *const dest[]);
+
+// dest = sha256d_80() of a header whose first 64 bytes produced midstate (in the
+// ASIC job order written by sha256_midstates_64_rolled()); tail is header bytes 64..79
+void sha256d_80_midstate(const uint8_t midstate[32], const uint8_t tail[16], uint8_t dest[32]);
+
+#endif // SHA256_KERNELS_H_
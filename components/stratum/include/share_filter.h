@@ -0,0 +1,31 @@
+#ifndef SHARE_FILTER_H_
+#define SHARE_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Remembers the most recent shares so a nonce the ASIC returns twice, or a
+// nonce range searched again after a restart, is not submitted twice. Shares
+// are reduced to a 64-bit fingerprint kept in an open-addressed hash table;
+// a ring of fingerprints in insertion order evicts the oldest one once full.
+
+#define SHARE_FILTER_CAPACITY 128
+#define SHARE_FILTER_SLOTS (SHARE_FILTER_CAPACITY * 2) // power of two, load factor <= 0.5
+
+typedef struct
+{
+    uint64_t slots[SHARE_FILTER_SLOTS]; // 0 marks an empty slot
+    uint64_t ring[SHARE_FILTER_CAPACITY];
+    uint16_t ring_head;
+    uint16_t count;
+} share_filter;
+
+void share_filter_init(share_filter *filter);
+
+// Covers every submitted field; rolled ntime jobs share jobid and extranonce2
+uint64_t share_filter_key(const char *jobid, const char *extranonce2, uint32_t ntime, uint32_t nonce, uint32_t version_bits);
+
+// Returns true if key is among the remembered shares; otherwise remembers it
+bool share_filter_check_and_add(share_filter *filter, uint64_t key);
+
+#endif // SHARE_FILTER_H_
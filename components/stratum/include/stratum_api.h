@@ -43,12 +43,24 @@ typedef struct
     char *prev_block_hash;
     char *coinbase_1;
     char *coinbase_2;
+    // coinbase_1/coinbase_2 decoded once at parse time, job generation
+    // builds its coinbase template from these instead of the hex strings
+    uint8_t *coinbase_1_bin;
+    size_t coinbase_1_len;
+    uint8_t *coinbase_2_bin;
+    size_t coinbase_2_len;
+    // prev_block_hash decoded once at parse time, in block header byte order (the
+    // midstate input) and in bm_job/ASIC order, see decode_prev_block_hash()
+    uint8_t prev_block_hash_header[32];
+    uint8_t prev_block_hash_asic[32];
     uint8_t *merkle_branches;
     size_t n_merkle_branches;
     uint32_t version;
     uint32_t target;
     uint32_t ntime;
     bool clean_jobs;
+    // esp_timer_get_time() when the notify line arrived, bounds ntime rolling
+    int64_t received_time_us;
 } mining_notify;
 
 typedef struct
@@ -108,6 +120,17 @@ int STRATUM_V1_submit_share(esp_transport_handle_t transport, int send_uid, cons
                             const char *extranonce_2, const uint32_t ntime, const uint32_t nonce,
                             const uint32_t version_bits, uint64_t *out_sent_time_us);
 
+// Formats one newline-terminated mining.submit into buf.
+// Returns its length, or -1 if it does not fit.
+int STRATUM_V1_format_submit(char *buf, size_t buf_len, int send_uid, const char *username, const char *job_id,
+                             const char *extranonce_2, const uint32_t ntime, const uint32_t nonce,
+                             const uint32_t version_bits);
+
+// Writes one or more formatted submits in a single transport write and starts
+// response timing for each of their ids.
+int STRATUM_V1_submit_batch(esp_transport_handle_t transport, const char *msgs, size_t len,
+                            const int *send_uids, int count, uint64_t *out_sent_time_us);
+
 float STRATUM_V1_get_response_time_ms(int request_id, int64_t receive_time_us);
 
 #endif // STRATUM_API_H
\ No newline at end of file
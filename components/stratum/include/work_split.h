@@ -0,0 +1,20 @@
+#ifndef WORK_SPLIT_H_
+#define WORK_SPLIT_H_
+
+#include <stdbool.h>
+
+// Splits one piece of CPU-bound work in two: the caller runs fn_a while a helper
+// task, pinned to the core opposite the caller, runs fn_b.
+// Without the helper (unicore or host builds, init failed, a split already in
+// flight) both halves run on the caller, so results never depend on the split.
+
+typedef void (*work_split_fn)(void *arg);
+
+// Start the helper task; safe to call more than once. The calling task must be
+// pinned to a core, the helper is pinned to the other one.
+bool work_split_init(void);
+
+// Run fn_a(arg_a) and fn_b(arg_b), returning once both have finished
+void work_split_run(work_split_fn fn_a, void *arg_a, work_split_fn fn_b, void *arg_b);
+
+#endif // WORK_SPLIT_H_
@@ -0,0 +1,80 @@
+#include "job_table.h"
+
+void job_table_init(job_table *table, job_slot *slots)
+{
+    table->slots = slots;
+    // Zeroed slots carry epoch 0 and so start out invalid
+    atomic_store(&table->epoch, 1);
+}
+
+void job_table_publish(job_table *table, uint8_t id, const bm_job *job)
+{
+    job_slot *slot = &table->slots[id % BM_JOB_POOL_SIZE];
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->job = *job;
+    slot->epoch = atomic_load_explicit(&table->epoch, memory_order_relaxed);
+
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+void job_table_invalidate_all(job_table *table)
+{
+    atomic_fetch_add_explicit(&table->epoch, 1, memory_order_release);
+}
+
+// Opens a read of slot; returns false while the slot is being rewritten
+static inline bool read_begin(job_slot *slot, unsigned *seq)
+{
+    *seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    return (*seq & 1) == 0;
+}
+
+// True if nothing was written to slot since read_begin() returned seq
+static inline bool read_end(job_slot *slot, unsigned seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq;
+}
+
+bool job_table_read_version(job_table *table, uint8_t id, uint32_t *version, uint32_t *version_mask,
+                            uint32_t *generation)
+{
+    job_slot *slot = &table->slots[id % BM_JOB_POOL_SIZE];
+    unsigned seq;
+
+    // A slot rewritten under us now holds a different job; the nonce was for
+    // the old one, so there is nothing to retry
+    if (!read_begin(slot, &seq)) {
+        return false;
+    }
+    uint32_t epoch = slot->epoch;
+    *version = slot->job.version;
+    *version_mask = slot->job.version_mask;
+    if (!read_end(slot, seq)) {
+        return false;
+    }
+
+    *generation = seq;
+    return epoch == atomic_load_explicit(&table->epoch, memory_order_acquire);
+}
+
+bool job_table_read(job_table *table, uint8_t id, uint32_t generation, bm_job *out)
+{
+    job_slot *slot = &table->slots[id % BM_JOB_POOL_SIZE];
+    unsigned seq;
+
+    if (!read_begin(slot, &seq) || seq != generation) {
+        return false;
+    }
+    uint32_t epoch = slot->epoch;
+    *out = slot->job;
+    if (!read_end(slot, seq)) {
+        return false;
+    }
+
+    return epoch == atomic_load_explicit(&table->epoch, memory_order_acquire);
+}
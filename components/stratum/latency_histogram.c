@@ -0,0 +1,67 @@
+#include "latency_histogram.h"
+
+#include <string.h>
+
+static int bucket_index(uint32_t value)
+{
+    if (value < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+    int exponent = 31 - __builtin_clz(value);
+    if (exponent > LATENCY_HISTOGRAM_MAX_EXPONENT) {
+        return LATENCY_HISTOGRAM_BUCKETS - 1;
+    }
+    int shift = exponent - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    int sub_bucket = (value >> shift) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+    return (shift + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+// Largest value that maps to the bucket
+static uint32_t bucket_upper_edge(int index)
+{
+    if (index < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    int shift = index / LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+    uint32_t lower = (uint32_t)(LATENCY_HISTOGRAM_SUB_BUCKETS + index % LATENCY_HISTOGRAM_SUB_BUCKETS) << shift;
+    return lower + (1u << shift) - 1;
+}
+
+void latency_histogram_reset(latency_histogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void latency_histogram_record(latency_histogram *histogram, uint32_t latency_us)
+{
+    histogram->buckets[bucket_index(latency_us)]++;
+    histogram->count++;
+    if (latency_us > histogram->max_us) {
+        histogram->max_us = latency_us;
+    }
+}
+
+uint32_t latency_histogram_percentile(const latency_histogram *histogram, float percentile)
+{
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    // Nearest-rank: the smallest sample with at least percentile% of samples at or below it
+    uint32_t rank = (uint32_t)(percentile / 100.0f * histogram->count + 0.999f);
+    if (rank < 1) rank = 1;
+    if (rank > histogram->count) rank = histogram->count;
+
+    uint32_t seen = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            if (i == LATENCY_HISTOGRAM_BUCKETS - 1) {
+                break; // Open-ended
+            }
+            uint32_t edge = bucket_upper_edge(i);
+            return edge < histogram->max_us ? edge : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
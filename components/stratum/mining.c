@@ -1,18 +1,20 @@
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
+#include <inttypes.h>
+#include <math.h>
 #include "mining.h"
 #include "utils.h"
+#include "sha256_kernels.h"
+#include "work_split.h"
 #include "mbedtls/sha256.h"
 #include "esp_log.h"
 
-void free_bm_job(bm_job *job)
-{
-    free(job->jobid);
-    free(job->extranonce2);
-    free(job);
-}
-
 void calculate_coinbase_tx_hash(const char *coinbase_1, const char *coinbase_2, const char *extranonce, const char *extranonce_2, uint8_t dest[32])
 {
     size_t len1 = strlen(coinbase_1);
@@ -33,24 +35,55 @@ void calculate_coinbase_tx_hash(const char *coinbase_1, const char *coinbase_2,
     double_sha256_bin(coinbase_tx_bin, coinbase_tx_bin_len, dest);
 }
 
-void calculate_coinbase_tx_hash_bin(const uint8_t *prefix, size_t prefix_len,
-                                    const uint8_t *extranonce_prefix, size_t ep_len,
-                                    const uint8_t *extranonce_2, size_t e2_len,
-                                    const uint8_t *suffix, size_t suffix_len,
-                                    uint8_t dest[32])
+bool coinbase_template_init(coinbase_template *tmpl, const uint8_t *prefix, size_t prefix_len,
+                            const uint8_t *extranonce_prefix, size_t ep_len, size_t e2_len,
+                            const uint8_t *suffix, size_t suffix_len)
 {
     size_t total_len = prefix_len + ep_len + e2_len + suffix_len;
-    uint8_t *buf = malloc(total_len);
-    if (!buf) return;
+    uint8_t *tx = realloc(tmpl->tx, total_len);
+    if (!tx) return false;
 
     size_t offset = 0;
-    memcpy(buf + offset, prefix, prefix_len);   offset += prefix_len;
-    memcpy(buf + offset, extranonce_prefix, ep_len); offset += ep_len;
-    memcpy(buf + offset, extranonce_2, e2_len); offset += e2_len;
-    memcpy(buf + offset, suffix, suffix_len);
+    memcpy(tx + offset, prefix, prefix_len);   offset += prefix_len;
+    memcpy(tx + offset, extranonce_prefix, ep_len); offset += ep_len;
+    memset(tx + offset, 0, e2_len);            offset += e2_len;
+    memcpy(tx + offset, suffix, suffix_len);
+
+    tmpl->tx = tx;
+    tmpl->tx_len = total_len;
+    tmpl->extranonce_2_offset = prefix_len + ep_len;
+    tmpl->extranonce_2_len = e2_len;
+
+    // Hash the constant blocks in front of extranonce_2 once
+    tmpl->prefix_hashed = tmpl->extranonce_2_offset & ~(size_t)63;
+    mbedtls_sha256_free(&tmpl->prefix_ctx);
+    mbedtls_sha256_init(&tmpl->prefix_ctx);
+    mbedtls_sha256_starts(&tmpl->prefix_ctx, 0);
+    mbedtls_sha256_update(&tmpl->prefix_ctx, tx, tmpl->prefix_hashed);
+    return true;
+}
+
+void coinbase_template_free(coinbase_template *tmpl)
+{
+    free(tmpl->tx);
+    mbedtls_sha256_free(&tmpl->prefix_ctx);
+    memset(tmpl, 0, sizeof(coinbase_template));
+}
+
+void calculate_coinbase_tx_hash_template(coinbase_template *tmpl, const uint8_t *extranonce_2, uint8_t dest[32])
+{
+    memcpy(tmpl->tx + tmpl->extranonce_2_offset, extranonce_2, tmpl->extranonce_2_len);
+
+    // Resume from the cached prefix state and only hash the tail
+    uint8_t first_hash_output[32];
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_clone(&ctx, &tmpl->prefix_ctx);
+    mbedtls_sha256_update(&ctx, tmpl->tx + tmpl->prefix_hashed, tmpl->tx_len - tmpl->prefix_hashed);
+    mbedtls_sha256_finish(&ctx, first_hash_output);
+    mbedtls_sha256_free(&ctx);
 
-    double_sha256_bin(buf, total_len, dest);
-    free(buf);
+    mbedtls_sha256(first_hash_output, 32, dest, 0);
 }
 
 void calculate_merkle_root_hash(const uint8_t coinbase_tx_hash[32], const uint8_t merkle_branches[][32], const int num_merkle_branches, uint8_t dest[32])
@@ -59,74 +92,176 @@ void calculate_merkle_root_hash(const uint8_t coinbase_tx_hash[32], const uint8_
     memcpy(both_merkles, coinbase_tx_hash, 32);
     for (int i = 0; i < num_merkle_branches; i++) {
         memcpy(both_merkles + 32, merkle_branches[i], 32);
-        double_sha256_bin(both_merkles, 64, both_merkles);
+        sha256d_64(both_merkles, both_merkles);
     }
 
     memcpy(dest, both_merkles, 32);
 }
 
 // take a mining_notify struct with ascii hex strings and convert it to a bm_job struct
-void construct_bm_job(mining_notify *params, const uint8_t merkle_root[32], const uint32_t version_mask, const double difficulty, bm_job *new_job)
+#ifdef CONFIG_STRATUM_PARALLEL_MIDSTATES
+#define SPLIT_MIDSTATES true
+#else
+#define SPLIT_MIDSTATES false
+#endif
+
+typedef struct
+{
+    const uint8_t *header;
+    const uint32_t *versions;
+    int count;
+    uint8_t *const *dest;
+} midstate_batch;
+
+static void midstate_batch_run(void *arg)
+{
+    midstate_batch *batch = arg;
+    sha256_midstates_64_rolled(batch->header, batch->versions, batch->count, batch->dest);
+}
+
+void calculate_rolled_midstates(const uint8_t header[64], const uint32_t *versions, int count, uint8_t *const dest[], bool split)
+{
+    if (!split || count < 2) {
+        sha256_midstates_64_rolled(header, versions, count, dest);
+        return;
+    }
+
+    int first = count / 2;
+    midstate_batch a = { header, versions, first, dest };
+    midstate_batch b = { header, versions + first, count - first, dest + first };
+    work_split_run(midstate_batch_run, &a, midstate_batch_run, &b);
+}
+
+void decode_prev_block_hash(const char *prev_block_hash, uint8_t header_order[32], uint8_t asic_order[32])
+{
+    hex2bin(prev_block_hash, header_order, 32);
+    reverse_endianness_per_word(header_order);
+    reverse_32bit_words(header_order, asic_order);
+}
+
+static void fill_bm_job_header(uint32_t version, const uint8_t prev_block_hash_header[32], const uint8_t prev_block_hash_asic[32],
+                               const uint8_t merkle_root[32], uint32_t ntime, uint32_t nbits, uint32_t version_mask,
+                               double difficulty, bm_job *new_job)
 {
-    new_job->version = params->version;
-    new_job->target = params->target;
-    new_job->ntime = params->ntime;
+    new_job->version = version;
+    new_job->target = nbits;
+    new_job->ntime = ntime;
     new_job->starting_nonce = 0;
     new_job->pool_diff = difficulty;
+    new_job->version_mask = version_mask;
     reverse_32bit_words(merkle_root, new_job->merkle_root);
+    memcpy(new_job->prev_block_hash, prev_block_hash_asic, 32);
 
-    uint8_t prev_block_hash[32];
-    hex2bin(params->prev_block_hash, prev_block_hash, 32);
-    reverse_endianness_per_word(prev_block_hash);
-    reverse_32bit_words(prev_block_hash, new_job->prev_block_hash);
-
-    // make the midstate hash
+    // First 64 header bytes: version, prev_block_hash, merkle_root[0..28]
     uint8_t midstate_data[64];
+    memcpy(midstate_data, &version, 4);
+    memcpy(midstate_data + 4, prev_block_hash_header, 32);
+    memcpy(midstate_data + 36, merkle_root, 28);
 
-    // copy 64 bytes header data into midstate (and deal with endianess)
-    memcpy(midstate_data, &new_job->version, 4);      // copy version
-    memcpy(midstate_data + 4, prev_block_hash, 32);   // copy prev_block_hash
-    memcpy(midstate_data + 36, merkle_root, 28);      // copy merkle_root
+    uint32_t versions[4] = { version };
+    int num_midstates = 1;
+    if (version_mask != 0) {
+        for (; num_midstates < 4; num_midstates++) {
+            versions[num_midstates] = increment_bitmask(versions[num_midstates - 1], version_mask);
+        }
+    }
 
-    uint8_t midstate[32];
-    midstate_sha256_bin(midstate_data, 64, midstate); // make the midstate hash
-    reverse_32bit_words(midstate, new_job->midstate); // reverse the midstate words for the BM job packet
+    uint8_t *const midstates[4] = { new_job->midstate, new_job->midstate1, new_job->midstate2, new_job->midstate3 };
+    calculate_rolled_midstates(midstate_data, versions, num_midstates, midstates, SPLIT_MIDSTATES);
+    new_job->num_midstates = num_midstates;
+}
 
-    if (version_mask != 0)
-    {
-        uint32_t rolled_version = increment_bitmask(new_job->version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, new_job->midstate1);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, new_job->midstate2);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, new_job->midstate3);
-        new_job->num_midstates = 4;
-    }
-    else
-    {
-        new_job->num_midstates = 1;
+void construct_bm_job_header(uint32_t version, const uint8_t prev_block_hash[32], const uint8_t merkle_root[32],
+                             uint32_t ntime, uint32_t nbits, uint32_t version_mask, double difficulty, bm_job *new_job)
+{
+    uint8_t prev_block_hash_asic[32];
+    reverse_32bit_words(prev_block_hash, prev_block_hash_asic);
+    fill_bm_job_header(version, prev_block_hash, prev_block_hash_asic, merkle_root, ntime, nbits, version_mask,
+                       difficulty, new_job);
+}
+
+void construct_bm_job(mining_notify *params, const uint8_t merkle_root[32], const uint32_t version_mask, const double difficulty, bm_job *new_job)
+{
+    fill_bm_job_header(params->version, params->prev_block_hash_header, params->prev_block_hash_asic, merkle_root,
+                       params->ntime, params->target, version_mask, difficulty, new_job);
+}
+
+void construct_bm_job_v1(mining_notify *notification, coinbase_template *tmpl, uint64_t extranonce_2,
+                         uint32_t version_mask, double difficulty, bm_job *job)
+{
+    uint8_t extranonce_2_bin[tmpl->extranonce_2_len];
+    extranonce_2_generate_bin(extranonce_2, tmpl->extranonce_2_len, extranonce_2_bin);
+
+    uint8_t coinbase_tx_hash[32];
+    calculate_coinbase_tx_hash_template(tmpl, extranonce_2_bin, coinbase_tx_hash);
+
+    uint8_t merkle_root[32];
+    calculate_merkle_root_hash(coinbase_tx_hash, (uint8_t(*)[32])notification->merkle_branches, notification->n_merkle_branches, merkle_root);
+
+    construct_bm_job(notification, merkle_root, version_mask, difficulty, job);
+
+    strncpy(job->jobid, notification->job_id, sizeof(job->jobid) - 1);
+    job->jobid[sizeof(job->jobid) - 1] = '\0';
+    bin2hex(extranonce_2_bin, tmpl->extranonce_2_len, job->extranonce2, sizeof(job->extranonce2));
+}
+
+// SV2 provides merkle_root and prev_hash in internal byte order (SHA-256 output order),
+// which is the header order construct_bm_job_header expects.
+void construct_bm_job_sv2(uint32_t job_id, uint32_t version, const uint8_t merkle_root[32], const uint8_t prev_hash[32],
+                          uint32_t ntime, uint32_t nbits, uint32_t version_mask, double difficulty, bm_job *job)
+{
+    construct_bm_job_header(version, prev_hash, merkle_root, ntime, nbits, version_mask, difficulty, job);
+
+    snprintf(job->jobid, sizeof(job->jobid), "%" PRIu32, job_id);
+    job->extranonce2[0] = '\0'; // unused in SV2 standard
+}
+
+// Extended channel: coinbase hash from prefix+extranonce+suffix, then merkle root
+// from merkle path. ntime is not rolled, extranonce_2 provides uniqueness.
+void construct_bm_job_sv2_ext(uint32_t job_id, uint32_t version, const uint8_t prev_hash[32], uint32_t ntime, uint32_t nbits,
+                              const uint8_t merkle_path[][32], int merkle_path_count, coinbase_template *tmpl,
+                              uint64_t extranonce_2, uint32_t version_mask, double difficulty, bm_job *job)
+{
+    // SV2 spec: extranonce_size is the miner's rollable portion (not total).
+    // Encode the counter as big-endian bytes.
+    size_t extranonce_2_len = tmpl->extranonce_2_len;
+    uint8_t extranonce_2_bin[extranonce_2_len];
+    memset(extranonce_2_bin, 0, extranonce_2_len);
+    for (int i = extranonce_2_len - 1; i >= 0 && extranonce_2 > 0; i--) {
+        extranonce_2_bin[i] = (uint8_t)(extranonce_2 & 0xFF);
+        extranonce_2 >>= 8;
     }
+
+    uint8_t coinbase_tx_hash[32];
+    calculate_coinbase_tx_hash_template(tmpl, extranonce_2_bin, coinbase_tx_hash);
+
+    uint8_t merkle_root[32];
+    calculate_merkle_root_hash(coinbase_tx_hash, merkle_path, merkle_path_count, merkle_root);
+
+    construct_bm_job_header(version, prev_hash, merkle_root, ntime, nbits, version_mask, difficulty, job);
+
+    snprintf(job->jobid, sizeof(job->jobid), "%" PRIu32, job_id);
+
+    // Store extranonce_2 as hex for share submission
+    bin2hex(extranonce_2_bin, extranonce_2_len, job->extranonce2, sizeof(job->extranonce2));
 }
 
-void extranonce_2_generate(uint64_t extranonce_2, uint32_t length, char dest[static length * 2 + 1])
+void extranonce_2_generate_bin(uint64_t extranonce_2, uint32_t length, uint8_t dest[static length])
 {
-    // Allocate buffer to hold the extranonce_2 value in bytes
-    uint8_t extranonce_2_bytes[length];
-    memset(extranonce_2_bytes, 0, length);
-    
+    memset(dest, 0, length);
+
     // Copy the extranonce_2 value into the buffer, handling endianness
     // Copy up to the size of uint64_t or the requested length, whichever is smaller
     size_t copy_len = (length < sizeof(uint64_t)) ? length : sizeof(uint64_t);
-    memcpy(extranonce_2_bytes, &extranonce_2, copy_len);
-    
+    memcpy(dest, &extranonce_2, copy_len);
+}
+
+void extranonce_2_generate(uint64_t extranonce_2, uint32_t length, char dest[static length * 2 + 1])
+{
+    // Allocate buffer to hold the extranonce_2 value in bytes
+    uint8_t extranonce_2_bytes[length];
+    extranonce_2_generate_bin(extranonce_2, length, extranonce_2_bytes);
+
     // Convert the bytes to hex string
     bin2hex(extranonce_2_bytes, length, dest, length * 2 + 1);
 }
@@ -138,28 +273,99 @@ double hash_to_pdiff(const uint8_t hash[32])
     return truediffone / s64;
 }
 
-///////cgminer nonce testing
-/* testing a nonce and return the diff - 0 means invalid */
-double test_nonce_value(const bm_job *job, const uint32_t nonce, const uint32_t rolled_version)
+void pdiff_to_target(double difficulty, uint8_t target[32])
 {
-    uint8_t header[80];
+    if (!(difficulty > 0.0)) {
+        memset(target, 0xFF, 32);
+        return;
+    }
+    double value = truediffone / difficulty;
+    for (int i = 31; i >= 0; i--) {
+        double byte = floor(ldexp(value, -8 * i));
+        if (byte > 255.0) byte = 255.0;
+        target[i] = (uint8_t)byte;
+        value -= ldexp(byte, 8 * i);
+    }
+}
+
+double difficulty_for_share_rate(float hashrate_ghs, float shares_per_minute)
+{
+    if (hashrate_ghs <= 0.0f || shares_per_minute <= 0.0f) return 0.0;
+    // A share of difficulty 1 takes 2^32 hashes on average
+    return hashrate_ghs * 1e9 * 60.0 / (shares_per_minute * 4294967296.0);
+}
 
-    // // TODO: use the midstate hash instead of hashing the whole header
-    // uint32_t rolled_version = job->version;
-    // for (int i = 0; i < midstate_index; i++) {
-    //     rolled_version = increment_bitmask(rolled_version, job->version_mask);
-    // }
+uint32_t ntime_roll_limit(uint32_t notify_ntime, int64_t received_time_us, int64_t now_us)
+{
+    int64_t elapsed_s = now_us > received_time_us ? (now_us - received_time_us) / 1000000 : 0;
+    return notify_ntime + (uint32_t)elapsed_s + NTIME_ROLL_ALLOWANCE_S;
+}
 
-    // copy data from job to header
+// Midstate built for rolled_version at job construction time, or NULL when the
+// ASIC rolled to a version outside the ones the job carries midstates for
+static const uint8_t *job_midstate_for_version(const bm_job *job, uint32_t rolled_version)
+{
+    if (rolled_version == job->version) return job->midstate;
+    if (job->num_midstates < 4) return NULL;
+
+    const uint8_t *rolled_midstates[3] = { job->midstate1, job->midstate2, job->midstate3 };
+    uint32_t version = job->version;
+    for (int i = 0; i < 3; i++) {
+        version = increment_bitmask(version, job->version_mask);
+        if (version == rolled_version) return rolled_midstates[i];
+    }
+    return NULL;
+}
+
+static void hash_nonce(const bm_job *job, uint32_t nonce, uint32_t rolled_version, uint8_t hash_result[32])
+{
+    const uint8_t *midstate = job_midstate_for_version(job, rolled_version);
+    if (midstate) {
+        // Header bytes 64..79: last merkle_root word (first in ASIC order), ntime, nbits, nonce
+        uint8_t tail[16];
+        memcpy(tail, job->merkle_root, 4);
+        memcpy(tail + 4, &job->ntime, 4);
+        memcpy(tail + 8, &job->target, 4);
+        memcpy(tail + 12, &nonce, 4);
+        sha256d_80_midstate(midstate, tail, hash_result);
+        return;
+    }
+
+    uint8_t header[80];
     memcpy(header, &rolled_version, 4);
     reverse_32bit_words(job->prev_block_hash, header + 4);
     reverse_32bit_words(job->merkle_root, header + 36);
     memcpy(header + 68, &job->ntime, 4);
     memcpy(header + 72, &job->target, 4);
     memcpy(header + 76, &nonce, 4);
+    sha256d_80(header, hash_result);
+}
 
+///////cgminer nonce testing
+/* testing a nonce and return the diff - 0 means invalid */
+double test_nonce_value(const bm_job *job, const uint32_t nonce, const uint32_t rolled_version)
+{
     uint8_t hash_result[32];
-    double_sha256_bin(header, 80, hash_result);
+    hash_nonce(job, nonce, rolled_version, hash_result);
+
+    return hash_to_pdiff(hash_result);
+}
+
+// truediffone / 2^192: the top 64-bit hash word at which difficulty is 1
+#define TRUEDIFFONE_TOP64 4294901760.0
+
+double test_nonce_value_min(const bm_job *job, const uint32_t nonce, const uint32_t rolled_version, const double min_diff)
+{
+    uint8_t hash_result[32];
+    hash_nonce(job, nonce, rolled_version, hash_result);
+
+    // hash >= top64 * 2^192, so once top64 exceeds truediffone / min_diff / 2^192
+    // the difficulty is below min_diff and le256todouble() can be skipped
+    if (min_diff >= 1.0) {
+        uint64_t top64;
+        memcpy(&top64, hash_result + 24, 8);
+        if (top64 > (uint64_t)(TRUEDIFFONE_TOP64 / min_diff)) return 0.0;
+    }
 
     return hash_to_pdiff(hash_result);
 }
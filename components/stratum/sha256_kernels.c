@@ -0,0 +1,289 @@
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#include <string.h>
+#include "sha256_kernels.h"
+
+#ifdef CONFIG_STRATUM_SHA256_HW
+#include "mbedtls/sha256.h"
+#endif
+
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define EP0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define EP1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SIG0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SIG1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+#define ROUND(a, b, c, d, e, f, g, h, kw)                     \
+    do {                                                      \
+        uint32_t t1 = (h) + EP1(e) + CH(e, f, g) + (kw);      \
+        uint32_t t2 = EP0(a) + MAJ(a, b, c);                  \
+        (d) += t1;                                            \
+        (h) = t1 + t2;                                        \
+    } while (0)
+
+// Eight rounds with the working variables rotated by name instead of by copy
+#define ROUND8(KW, i)                                         \
+    ROUND(a, b, c, d, e, f, g, h, KW(i));                     \
+    ROUND(h, a, b, c, d, e, f, g, KW(i + 1));                 \
+    ROUND(g, h, a, b, c, d, e, f, KW(i + 2));                 \
+    ROUND(f, g, h, a, b, c, d, e, KW(i + 3));                 \
+    ROUND(e, f, g, h, a, b, c, d, KW(i + 4));                 \
+    ROUND(d, e, f, g, h, a, b, c, KW(i + 5));                 \
+    ROUND(c, d, e, f, g, h, a, b, KW(i + 6));                 \
+    ROUND(b, c, d, e, f, g, h, a, KW(i + 7))
+
+#define ROUNDS64(state, KW)                                   \
+    do {                                                      \
+        uint32_t a = (state)[0], b = (state)[1];              \
+        uint32_t c = (state)[2], d = (state)[3];              \
+        uint32_t e = (state)[4], f = (state)[5];              \
+        uint32_t g = (state)[6], h = (state)[7];              \
+        ROUND8(KW, 0);                                        \
+        ROUND8(KW, 8);                                        \
+        ROUND8(KW, 16);                                       \
+        ROUND8(KW, 24);                                       \
+        ROUND8(KW, 32);                                       \
+        ROUND8(KW, 40);                                       \
+        ROUND8(KW, 48);                                       \
+        ROUND8(KW, 56);                                       \
+        (state)[0] += a; (state)[1] += b;                     \
+        (state)[2] += c; (state)[3] += d;                     \
+        (state)[4] += e; (state)[5] += f;                     \
+        (state)[6] += g; (state)[7] += h;                     \
+    } while (0)
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// W[0..15] must hold the message block; the rest of the schedule is expanded here
+static void sha256_transform(uint32_t state[8], uint32_t W[64])
+{
+    for (int i = 16; i < 64; i++) {
+        W[i] = SIG1(W[i - 2]) + W[i - 7] + SIG0(W[i - 15]) + W[i - 16];
+    }
+#define KW_SCHEDULE(i) (K[i] + W[i])
+    ROUNDS64(state, KW_SCHEDULE);
+#undef KW_SCHEDULE
+}
+
+// Second pass of a double SHA-256: hash the 32-byte first digest held as state words
+static void sha256_final_32(const uint32_t first[8], uint8_t dest[32])
+{
+    uint32_t W[64];
+    memcpy(W, first, 32);
+    W[8] = 0x80000000;
+    memset(&W[9], 0, 6 * sizeof(uint32_t));
+    W[15] = 256;
+
+    uint32_t state[8];
+    memcpy(state, IV, sizeof(state));
+    sha256_transform(state, W);
+
+    for (int i = 0; i < 8; i++) {
+        store_be32(dest + i * 4, state[i]);
+    }
+}
+
+// Second block of an 80-byte message (16 header bytes, 0x80, zeros, bit length 640)
+// from the state after the first block, then the outer hash
+static void sha256d_80_tail(uint32_t state[8], const uint8_t tail[16], uint8_t dest[32])
+{
+    uint32_t W[64];
+    for (int i = 0; i < 4; i++) {
+        W[i] = load_be32(tail + i * 4);
+    }
+    W[4] = 0x80000000;
+    memset(&W[5], 0, 10 * sizeof(uint32_t));
+    W[15] = 640;
+    sha256_transform(state, W);
+
+    sha256_final_32(state, dest);
+}
+
+#ifdef CONFIG_STRATUM_SHA256_HW
+
+void sha256d_80(const uint8_t data[80], uint8_t dest[32])
+{
+    uint8_t first_hash[32];
+    mbedtls_sha256(data, 80, first_hash, 0);
+    mbedtls_sha256(first_hash, 32, dest, 0);
+}
+
+void sha256d_64(const uint8_t data[64], uint8_t dest[32])
+{
+    uint8_t first_hash[32];
+    mbedtls_sha256(data, 64, first_hash, 0);
+    mbedtls_sha256(first_hash, 32, dest, 0);
+}
+
+void sha256_midstate_64(const uint8_t data[64], uint8_t dest[32])
+{
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, data, 64);
+    memcpy(dest, ctx.state, 32);
+    mbedtls_sha256_free(&ctx);
+}
+
+void sha256_midstates_64_rolled(const uint8_t data[64], const uint32_t *versions, int count, uint8_t *const dest[])
+{
+    uint8_t block[64];
+    memcpy(block, data, 64);
+
+    for (int v = 0; v < count; v++) {
+        memcpy(block, &versions[v], 4);
+
+        mbedtls_sha256_context ctx;
+        mbedtls_sha256_init(&ctx);
+        mbedtls_sha256_starts(&ctx, 0);
+        mbedtls_sha256_update(&ctx, block, 64);
+        for (int i = 0; i < 8; i++) {
+            memcpy(dest[v] + i * 4, (const uint8_t *)ctx.state + (7 - i) * 4, 4);
+        }
+        mbedtls_sha256_free(&ctx);
+    }
+}
+
+#else
+
+// K[i] + W[i] for the padding-only block that follows a 64-byte message
+// (0x80, zeros, bit length 512). Its schedule never changes.
+static const uint32_t PAD64_KW[64] = {
+    0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+    0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254,
+    0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+    0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7,
+    0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+    0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd,
+    0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+    0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537,
+    0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+    0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7,
+    0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+    0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c,
+    0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76,
+};
+
+static void sha256_transform_pad64(uint32_t state[8])
+{
+#define KW_PAD64(i) (PAD64_KW[i])
+    ROUNDS64(state, KW_PAD64);
+#undef KW_PAD64
+}
+
+static void load_block(uint32_t W[16], const uint8_t *data)
+{
+    for (int i = 0; i < 16; i++) {
+        W[i] = load_be32(data + i * 4);
+    }
+}
+
+void sha256d_80(const uint8_t data[80], uint8_t dest[32])
+{
+    uint32_t W[64];
+    uint32_t state[8];
+    memcpy(state, IV, sizeof(state));
+
+    load_block(W, data);
+    sha256_transform(state, W);
+
+    sha256d_80_tail(state, data + 64, dest);
+}
+
+void sha256d_64(const uint8_t data[64], uint8_t dest[32])
+{
+    uint32_t W[64];
+    uint32_t state[8];
+    memcpy(state, IV, sizeof(state));
+
+    load_block(W, data);
+    sha256_transform(state, W);
+    sha256_transform_pad64(state);
+
+    sha256_final_32(state, dest);
+}
+
+void sha256_midstate_64(const uint8_t data[64], uint8_t dest[32])
+{
+    uint32_t W[64];
+    uint32_t state[8];
+    memcpy(state, IV, sizeof(state));
+
+    load_block(W, data);
+    sha256_transform(state, W);
+
+    for (int i = 0; i < 8; i++) {
+        store_be32(dest + i * 4, state[i]);
+    }
+}
+
+void sha256_midstates_64_rolled(const uint8_t data[64], const uint32_t *versions, int count, uint8_t *const dest[])
+{
+    // Words 1..15 are shared by every rolled version, load them once
+    uint32_t block[16];
+    load_block(block, data);
+
+    for (int v = 0; v < count; v++) {
+        uint8_t version_bytes[4];
+        memcpy(version_bytes, &versions[v], 4);
+
+        uint32_t W[64];
+        memcpy(W, block, sizeof(block));
+        W[0] = load_be32(version_bytes);
+
+        uint32_t state[8];
+        memcpy(state, IV, sizeof(state));
+        sha256_transform(state, W);
+
+        for (int i = 0; i < 8; i++) {
+            store_be32(dest[v] + (7 - i) * 4, state[i]);
+        }
+    }
+}
+
+#endif // CONFIG_STRATUM_SHA256_HW
+
+// Always software: the second block has to resume from a cached midstate, which
+// the mbedtls API cannot be seeded with
+void sha256d_80_midstate(const uint8_t midstate[32], const uint8_t tail[16], uint8_t dest[32])
+{
+    uint32_t state[8];
+    for (int i = 0; i < 8; i++) {
+        state[i] = load_be32(midstate + (7 - i) * 4);
+    }
+    sha256d_80_tail(state, tail, dest);
+}
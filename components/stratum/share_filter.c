@@ -0,0 +1,87 @@
+#include "share_filter.h"
+
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void share_filter_init(share_filter *filter)
+{
+    memset(filter, 0, sizeof(*filter));
+}
+
+uint64_t share_filter_key(const char *jobid, const char *extranonce2, uint32_t ntime, uint32_t nonce, uint32_t version_bits)
+{
+    // The string terminators keep ("ab", "c") and ("a", "bc") apart
+    uint64_t hash = fnv1a(FNV_OFFSET_BASIS, jobid, strlen(jobid) + 1);
+    hash = fnv1a(hash, extranonce2, strlen(extranonce2) + 1);
+    hash = fnv1a(hash, &ntime, sizeof(ntime));
+    hash = fnv1a(hash, &nonce, sizeof(nonce));
+    hash = fnv1a(hash, &version_bits, sizeof(version_bits));
+    return hash ? hash : 1;
+}
+
+static inline uint32_t home_slot(uint64_t key)
+{
+    return (uint32_t)(key ^ (key >> 32)) & (SHARE_FILTER_SLOTS - 1);
+}
+
+static void remove_key(share_filter *filter, uint64_t key)
+{
+    uint32_t i = home_slot(key);
+    while (filter->slots[i] != key) {
+        if (filter->slots[i] == 0) {
+            return;
+        }
+        i = (i + 1) & (SHARE_FILTER_SLOTS - 1);
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless that would move them in front of their home slot
+    uint32_t hole = i;
+    for (uint32_t j = (i + 1) & (SHARE_FILTER_SLOTS - 1); filter->slots[j] != 0; j = (j + 1) & (SHARE_FILTER_SLOTS - 1)) {
+        uint32_t home = home_slot(filter->slots[j]);
+        if (((j - home) & (SHARE_FILTER_SLOTS - 1)) >= ((j - hole) & (SHARE_FILTER_SLOTS - 1))) {
+            filter->slots[hole] = filter->slots[j];
+            hole = j;
+        }
+    }
+    filter->slots[hole] = 0;
+}
+
+bool share_filter_check_and_add(share_filter *filter, uint64_t key)
+{
+    uint32_t i = home_slot(key);
+    while (filter->slots[i] != 0) {
+        if (filter->slots[i] == key) {
+            return true;
+        }
+        i = (i + 1) & (SHARE_FILTER_SLOTS - 1);
+    }
+
+    if (filter->count == SHARE_FILTER_CAPACITY) {
+        remove_key(filter, filter->ring[filter->ring_head]);
+        filter->count--;
+        // The deletion may have shifted entries into the probe run; search again
+        i = home_slot(key);
+        while (filter->slots[i] != 0) {
+            i = (i + 1) & (SHARE_FILTER_SLOTS - 1);
+        }
+    }
+
+    filter->slots[i] = key;
+    filter->ring[filter->ring_head] = key;
+    filter->ring_head = (filter->ring_head + 1) % SHARE_FILTER_CAPACITY;
+    filter->count++;
+    return false;
+}
@@ -5,6 +5,7 @@
  *****************************************************************************/
 
 #include "stratum_api.h"
+#include "mining.h"
 #include "cJSON.h"
 #include "esp_log.h"
 #include "esp_app_desc.h"
@@ -292,6 +293,7 @@ static bool parse_mining_notify(cJSON *json, StratumApiV1Message *message)
 
     new_work->job_id = strdup(job_id_item->valuestring);
     new_work->prev_block_hash = strdup(cJSON_GetArrayItem(params, 1)->valuestring);
+    decode_prev_block_hash(new_work->prev_block_hash, new_work->prev_block_hash_header, new_work->prev_block_hash_asic);
     new_work->coinbase_1 = strdup(cJSON_GetArrayItem(params, 2)->valuestring);
     new_work->coinbase_2 = strdup(cJSON_GetArrayItem(params, 3)->valuestring);
 
@@ -320,6 +322,19 @@ static bool parse_mining_notify(cJSON *json, StratumApiV1Message *message)
         hex2bin(cJSON_GetArrayItem(merkle_branch, i)->valuestring, new_work->merkle_branches + HASH_SIZE * i, HASH_SIZE);
     }
 
+    new_work->coinbase_1_len = strlen(new_work->coinbase_1) / 2;
+    new_work->coinbase_2_len = strlen(new_work->coinbase_2) / 2;
+    new_work->coinbase_1_bin = malloc(new_work->coinbase_1_len);
+    new_work->coinbase_2_bin = malloc(new_work->coinbase_2_len);
+    if ((new_work->coinbase_1_len > 0 && !new_work->coinbase_1_bin) ||
+        (new_work->coinbase_2_len > 0 && !new_work->coinbase_2_bin)) {
+        ESP_LOGE(TAG, "Memory allocation failed for coinbase in mining.notify");
+        STRATUM_V1_free_mining_notify(new_work);
+        return false;
+    }
+    hex2bin(new_work->coinbase_1, new_work->coinbase_1_bin, new_work->coinbase_1_len);
+    hex2bin(new_work->coinbase_2, new_work->coinbase_2_bin, new_work->coinbase_2_len);
+
     new_work->version = strtoul(cJSON_GetArrayItem(params, 5)->valuestring, NULL, 16);
     new_work->target = strtoul(cJSON_GetArrayItem(params, 6)->valuestring, NULL, 16);
     new_work->ntime = strtoul(cJSON_GetArrayItem(params, 7)->valuestring, NULL, 16);
@@ -620,6 +635,8 @@ void STRATUM_V1_free_mining_notify(mining_notify * params)
     free(params->prev_block_hash);
     free(params->coinbase_1);
     free(params->coinbase_2);
+    free(params->coinbase_1_bin);
+    free(params->coinbase_2_bin);
     free(params->merkle_branches);
     free(params);
 }
@@ -716,6 +733,46 @@ int STRATUM_V1_send_version(esp_transport_handle_t transport, int message_id)
     return esp_transport_write(transport, version_msg, strlen(version_msg), TRANSPORT_TIMEOUT_MS);
 }
 
+int STRATUM_V1_format_submit(char *buf, size_t buf_len, int send_uid, const char *username, const char *job_id,
+                             const char *extranonce_2, const uint32_t ntime, const uint32_t nonce,
+                             const uint32_t version_bits)
+{
+    int len = snprintf(buf, buf_len,
+        "{\"id\":%d,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%08lx\",\"%08lx\",\"%08lx\"]}\n",
+        send_uid, username, job_id, extranonce_2, ntime, nonce, version_bits);
+    if (len < 0 || (size_t)len >= buf_len) {
+        return -1;
+    }
+    return len;
+}
+
+int STRATUM_V1_submit_batch(esp_transport_handle_t transport, const char *msgs, size_t len,
+                            const int *send_uids, int count, uint64_t *out_sent_time_us)
+{
+    int ret = esp_transport_write(transport, msgs, len, TRANSPORT_TIMEOUT_MS);
+
+    uint64_t now = esp_timer_get_time();
+    if (out_sent_time_us) {
+        *out_sent_time_us = now;
+    }
+
+    // The batch is not NUL-terminated, so each message is logged with its own length
+    const char *msg = msgs;
+    const char *end = msgs + len;
+    for (int i = 0; i < count && msg < end; i++) {
+        const char *newline = memchr(msg, '\n', end - msg);
+        int msg_len = newline ? (int)(newline - msg) : (int)(end - msg);
+        ESP_LOGI(TAG, "tx: %.*s (%d bytes)", msg_len, msg, msg_len);
+        stamp_tx(send_uids[i], now);
+        if (newline == NULL) {
+            break;
+        }
+        msg = newline + 1;
+    }
+
+    return ret;
+}
+
 /// @param transport Transport to write to
 /// @param send_uid Message ID
 /// @param username The client’s user name.
@@ -730,22 +787,13 @@ int STRATUM_V1_submit_share(esp_transport_handle_t transport, int send_uid, cons
                             const uint32_t nonce, const uint32_t version_bits, uint64_t *out_sent_time_us)
 {
     char submit_msg[BUFFER_SIZE];
-    snprintf(submit_msg, sizeof(submit_msg),
-        "{\"id\":%d,\"method\":\"mining.submit\",\"params\":[\"%s\",\"%s\",\"%s\",\"%08lx\",\"%08lx\",\"%08lx\"]}\n",
-        send_uid, username, job_id, extranonce_2, ntime, nonce, version_bits);
-
-    int ret = esp_transport_write(transport, submit_msg, strlen(submit_msg), TRANSPORT_TIMEOUT_MS);
-
-    uint64_t now = esp_timer_get_time();
-    if (out_sent_time_us) {
-        *out_sent_time_us = now;
+    int len = STRATUM_V1_format_submit(submit_msg, sizeof(submit_msg), send_uid, username, job_id,
+                                       extranonce_2, ntime, nonce, version_bits);
+    if (len < 0) {
+        return -1;
     }
 
-    debug_stratum_tx(submit_msg);
-    
-    stamp_tx(send_uid, now);
-
-    return ret;
+    return STRATUM_V1_submit_batch(transport, submit_msg, len, &send_uid, 1, out_sent_time_us);
 }
 
 int STRATUM_V1_configure_version_rolling(esp_transport_handle_t transport, int send_uid, uint32_t * version_mask)
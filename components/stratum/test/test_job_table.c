@@ -0,0 +1,124 @@
+#include "unity.h"
+#include "job_table.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every field of a stress job is derived from one value, so a torn copy shows up
+// as fields that disagree
+static void fill_job(bm_job *job, uint32_t value)
+{
+    memset(job, (uint8_t)value, sizeof(*job));
+    job->version = value;
+    job->version_mask = ~value;
+    job->ntime = value;
+}
+
+static bool job_is_consistent(const bm_job *job)
+{
+    uint32_t value = job->version;
+    if (job->version_mask != ~value || job->ntime != value) {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(job->midstate3); i++) {
+        if (job->midstate3[i] != (uint8_t)value || (uint8_t)job->jobid[i] != (uint8_t)value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Job table publish, read and invalidate", "[job_table]")
+{
+    job_slot *slots = calloc(BM_JOB_POOL_SIZE, sizeof(job_slot));
+    job_table table;
+    job_table_init(&table, slots);
+
+    uint32_t version, version_mask, generation;
+    bm_job job, out;
+    TEST_ASSERT_FALSE(job_table_read_version(&table, 24, &version, &version_mask, &generation));
+
+    fill_job(&job, 0x20000004);
+    job_table_publish(&table, 24, &job);
+    TEST_ASSERT_TRUE(job_table_read_version(&table, 24, &version, &version_mask, &generation));
+    TEST_ASSERT_EQUAL_HEX32(0x20000004, version);
+    TEST_ASSERT_TRUE(job_table_read(&table, 24, generation, &out));
+    TEST_ASSERT_EQUAL_MEMORY(&job, &out, sizeof(bm_job));
+
+    // The slot is reused for a new job between the version read and the full read
+    fill_job(&job, 0x20000008);
+    job_table_publish(&table, 24, &job);
+    TEST_ASSERT_FALSE(job_table_read(&table, 24, generation, &out));
+
+    job_table_invalidate_all(&table);
+    TEST_ASSERT_FALSE(job_table_read_version(&table, 24, &version, &version_mask, &generation));
+
+    job_table_publish(&table, 24, &job);
+    TEST_ASSERT_TRUE(job_table_read_version(&table, 24, &version, &version_mask, &generation));
+    TEST_ASSERT_EQUAL_HEX32(0x20000008, version);
+
+    free(slots);
+}
+
+#define STRESS_PUBLISHES 200000
+
+typedef struct
+{
+    job_table *table;
+    atomic_bool done;
+    uint32_t reads;
+    uint32_t torn;
+} stress_ctx;
+
+static void *stress_reader(void *arg)
+{
+    stress_ctx *ctx = arg;
+    bm_job out;
+    uint8_t id = 0;
+
+    while (!atomic_load(&ctx->done)) {
+        uint32_t version, version_mask, generation;
+        id ^= 24;
+        if (!job_table_read_version(ctx->table, id, &version, &version_mask, &generation)) {
+            continue;
+        }
+        if (!job_table_read(ctx->table, id, generation, &out)) {
+            continue;
+        }
+        ctx->reads++;
+        if (!job_is_consistent(&out) || out.version != version) {
+            ctx->torn++;
+        }
+    }
+    return NULL;
+}
+
+TEST_CASE("Job table readers never see a torn job", "[job_table]")
+{
+    job_slot *slots = calloc(BM_JOB_POOL_SIZE, sizeof(job_slot));
+    job_table table;
+    job_table_init(&table, slots);
+
+    stress_ctx ctx = { .table = &table };
+    pthread_t reader;
+    TEST_ASSERT_EQUAL(0, pthread_create(&reader, NULL, stress_reader, &ctx));
+
+    // Only two slots in rotation so the reader keeps landing on a slot being rewritten
+    bm_job job;
+    uint8_t id = 0;
+    for (uint32_t i = 1; i <= STRESS_PUBLISHES; i++) {
+        id ^= 24;
+        fill_job(&job, i);
+        job_table_publish(&table, id, &job);
+        if (i % 1000 == 0) {
+            job_table_invalidate_all(&table);
+        }
+    }
+
+    atomic_store(&ctx.done, true);
+    pthread_join(reader, NULL);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, ctx.reads);
+    TEST_ASSERT_EQUAL_UINT32(0, ctx.torn);
+    free(slots);
+}
@@ -0,0 +1,52 @@
+#include "unity.h"
+#include "latency_histogram.h"
+
+TEST_CASE("Latency histogram is empty after reset", "[latency_histogram]")
+{
+    static latency_histogram histogram;
+    latency_histogram_record(&histogram, 1234);
+    latency_histogram_reset(&histogram);
+
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.max_us);
+    TEST_ASSERT_EQUAL_UINT32(0, latency_histogram_percentile(&histogram, 50));
+}
+
+TEST_CASE("Latency histogram percentiles stay within one sub-bucket", "[latency_histogram]")
+{
+    static latency_histogram histogram;
+    latency_histogram_reset(&histogram);
+
+    // 1..1000 ms, one sample each
+    for (uint32_t ms = 1; ms <= 1000; ms++) {
+        latency_histogram_record(&histogram, ms * 1000);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(1000, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(1000000, histogram.max_us);
+
+    const float percentiles[] = { 50, 90, 99 };
+    for (int i = 0; i < 3; i++) {
+        uint32_t exact_us = (uint32_t)(percentiles[i] * 10) * 1000;
+        uint32_t value_us = latency_histogram_percentile(&histogram, percentiles[i]);
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(exact_us, value_us);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(exact_us + exact_us / LATENCY_HISTOGRAM_SUB_BUCKETS, value_us);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1000000, latency_histogram_percentile(&histogram, 100));
+}
+
+TEST_CASE("Latency histogram keeps small and huge samples", "[latency_histogram]")
+{
+    static latency_histogram histogram;
+    latency_histogram_reset(&histogram);
+
+    latency_histogram_record(&histogram, 0);
+    latency_histogram_record(&histogram, 3);
+    TEST_ASSERT_EQUAL_UINT32(0, latency_histogram_percentile(&histogram, 50));
+    TEST_ASSERT_EQUAL_UINT32(3, latency_histogram_percentile(&histogram, 100));
+
+    // Beyond the last bucket: counted, and the max is still exact
+    latency_histogram_record(&histogram, UINT32_MAX);
+    TEST_ASSERT_EQUAL_UINT32(3, histogram.count);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, latency_histogram_percentile(&histogram, 100));
+}
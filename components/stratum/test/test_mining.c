@@ -1,6 +1,7 @@
 #include "unity.h"
 #include "mining.h"
 #include "utils.h"
+#include "work_split.h"
 
 #include <limits.h>
 #include <string.h>
@@ -25,6 +26,83 @@ TEST_CASE("Check coinbase tx construction", "[mining]")
     TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_coinbase_tx_hash, coinbase_tx_hash, 32);
 }
 
+TEST_CASE("Check coinbase template matches hex construction", "[mining]")
+{
+    const char *coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20020862062f503253482f04b8864e5008";
+    const char *coinbase_2 = "072f736c7573682f000000000100f2052a010000001976a914d23fcdf86f7e756a64a7a9688ef9903327048ed988ac00000000";
+    const char *extranonce = "e9695791";
+
+    uint8_t coinbase_1_bin[58];
+    uint8_t coinbase_2_bin[51];
+    uint8_t extranonce_bin[4];
+    hex2bin(coinbase_1, coinbase_1_bin, sizeof(coinbase_1_bin));
+    hex2bin(coinbase_2, coinbase_2_bin, sizeof(coinbase_2_bin));
+    hex2bin(extranonce, extranonce_bin, sizeof(extranonce_bin));
+
+    coinbase_template tmpl = { 0 };
+    TEST_ASSERT_TRUE(coinbase_template_init(&tmpl, coinbase_1_bin, sizeof(coinbase_1_bin), extranonce_bin, sizeof(extranonce_bin), 4,
+                                            coinbase_2_bin, sizeof(coinbase_2_bin)));
+    TEST_ASSERT_EQUAL(58 + 4, tmpl.extranonce_2_offset);
+    TEST_ASSERT_EQUAL(58 + 4 + 4 + 51, tmpl.tx_len);
+
+    // patch several extranonce_2 values into the same template
+    for (uint64_t i = 0; i < 3; i++) {
+        char extranonce_2[9];
+        uint8_t extranonce_2_bin[4];
+        extranonce_2_generate(i * 0x99999999, 4, extranonce_2);
+        extranonce_2_generate_bin(i * 0x99999999, 4, extranonce_2_bin);
+
+        uint8_t expected_hash[32];
+        calculate_coinbase_tx_hash(coinbase_1, coinbase_2, extranonce, extranonce_2, expected_hash);
+
+        uint8_t coinbase_tx_hash[32];
+        calculate_coinbase_tx_hash_template(&tmpl, extranonce_2_bin, coinbase_tx_hash);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_hash, coinbase_tx_hash, 32);
+    }
+
+    coinbase_template_free(&tmpl);
+    TEST_ASSERT_NULL(tmpl.tx);
+}
+
+TEST_CASE("Check coinbase template resumes from cached prefix state", "[mining]")
+{
+    // coinbase_1 + extranonce_1 spans more than two SHA-256 blocks
+    const char *coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff4b0389130cfabe6d6d5cbab26a2599e92916edec5657a94a0708ddb970f5c45b5d12905085617eff8e"
+                             "0100000000000000000000000000000000000000000000000000000000000000000000000000000000";
+    const char *coinbase_2 = "31650707758de07b010000000000001cfd7038212f736c7573682f000000000379ad0c2a000000001976a9147c154ed1dc59609e3d26abb2df2ea3d587cd8c4188ac00000000";
+    const char *extranonce = "0102030405060708";
+
+    size_t coinbase_1_len = strlen(coinbase_1) / 2;
+    size_t coinbase_2_len = strlen(coinbase_2) / 2;
+    uint8_t coinbase_1_bin[coinbase_1_len];
+    uint8_t coinbase_2_bin[coinbase_2_len];
+    uint8_t extranonce_bin[8];
+    hex2bin(coinbase_1, coinbase_1_bin, coinbase_1_len);
+    hex2bin(coinbase_2, coinbase_2_bin, coinbase_2_len);
+    hex2bin(extranonce, extranonce_bin, sizeof(extranonce_bin));
+
+    coinbase_template tmpl = { 0 };
+    TEST_ASSERT_TRUE(coinbase_template_init(&tmpl, coinbase_1_bin, coinbase_1_len, extranonce_bin, sizeof(extranonce_bin), 8,
+                                            coinbase_2_bin, coinbase_2_len));
+    TEST_ASSERT_EQUAL(128, tmpl.prefix_hashed);
+
+    for (uint64_t i = 0; i < 3; i++) {
+        char extranonce_2[17];
+        uint8_t extranonce_2_bin[8];
+        extranonce_2_generate(i, 8, extranonce_2);
+        extranonce_2_generate_bin(i, 8, extranonce_2_bin);
+
+        uint8_t expected_hash[32];
+        calculate_coinbase_tx_hash(coinbase_1, coinbase_2, extranonce, extranonce_2, expected_hash);
+
+        uint8_t coinbase_tx_hash[32];
+        calculate_coinbase_tx_hash_template(&tmpl, extranonce_2_bin, coinbase_tx_hash);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_hash, coinbase_tx_hash, 32);
+    }
+
+    coinbase_template_free(&tmpl);
+}
+
 // Values calculated from esp-miner/components/stratum/test/verifiers/merklecalc.py
 TEST_CASE("Validate merkle root calculation", "[mining]")
 {
@@ -88,6 +166,7 @@ TEST_CASE("Validate bm job construction", "[mining]")
 {
     mining_notify notify_message;
     notify_message.prev_block_hash = "bf44fd3513dc7b837d60e5c628b572b448d204a8000007490000000000000000";
+    decode_prev_block_hash(notify_message.prev_block_hash, notify_message.prev_block_hash_header, notify_message.prev_block_hash_asic);
     notify_message.version = 0x20000004;
     notify_message.target = 0x1705dd01;
     notify_message.ntime = 0x64658bd8;
@@ -105,6 +184,73 @@ TEST_CASE("Validate bm job construction", "[mining]")
     TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_midstate_bin_reversed, job.midstate, 32);
 }
 
+TEST_CASE("Validate V1 job builder matches step-by-step construction", "[mining]")
+{
+    const char *coinbase_1 = "01000000010000000000000000000000000000000000000000000000000000000000000000ffffffff20020862062f503253482f04b8864e5008";
+    const char *coinbase_2 = "072f736c7573682f000000000100f2052a010000001976a914d23fcdf86f7e756a64a7a9688ef9903327048ed988ac00000000";
+    uint8_t coinbase_1_bin[58];
+    uint8_t coinbase_2_bin[51];
+    hex2bin(coinbase_1, coinbase_1_bin, sizeof(coinbase_1_bin));
+    hex2bin(coinbase_2, coinbase_2_bin, sizeof(coinbase_2_bin));
+    uint8_t extranonce_1[4] = { 0xe9, 0x69, 0x57, 0x91 };
+
+    mining_notify notify_message = { 0 };
+    notify_message.job_id = "1b";
+    notify_message.prev_block_hash = "bf44fd3513dc7b837d60e5c628b572b448d204a8000007490000000000000000";
+    decode_prev_block_hash(notify_message.prev_block_hash, notify_message.prev_block_hash_header, notify_message.prev_block_hash_asic);
+    notify_message.version = 0x20000004;
+    notify_message.target = 0x1705dd01;
+    notify_message.ntime = 0x64658bd8;
+
+    coinbase_template tmpl = { 0 };
+    TEST_ASSERT_TRUE(coinbase_template_init(&tmpl, coinbase_1_bin, sizeof(coinbase_1_bin), extranonce_1, 4, 4,
+                                            coinbase_2_bin, sizeof(coinbase_2_bin)));
+    bm_job job;
+    construct_bm_job_v1(&notify_message, &tmpl, 0x99999999, 0x1fffe000, 1000, &job);
+    coinbase_template_free(&tmpl);
+
+    uint8_t coinbase_tx_hash[32];
+    calculate_coinbase_tx_hash(coinbase_1, coinbase_2, "e9695791", "99999999", coinbase_tx_hash);
+    bm_job expected = { 0 };
+    construct_bm_job(&notify_message, coinbase_tx_hash, 0x1fffe000, 1000, &expected);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.merkle_root, job.merkle_root, 32);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.midstate, job.midstate, 32);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected.midstate3, job.midstate3, 32);
+    TEST_ASSERT_EQUAL(4, job.num_midstates);
+    TEST_ASSERT_EQUAL_STRING("1b", job.jobid);
+    TEST_ASSERT_EQUAL_STRING("99999999", job.extranonce2);
+    TEST_ASSERT_EQUAL_UINT32(0x1fffe000, job.version_mask);
+}
+
+TEST_CASE("Split rolled midstates match the serial path", "[mining]")
+{
+    work_split_init();
+
+    uint8_t header[64];
+    for (int i = 0; i < 64; i++) {
+        header[i] = (uint8_t)(i * 13 + 5);
+    }
+    uint32_t versions[4] = { 0x20000004 };
+    for (int i = 1; i < 4; i++) {
+        versions[i] = increment_bitmask(versions[i - 1], 0x1fffe000);
+    }
+
+    for (int count = 1; count <= 4; count++) {
+        uint8_t serial[4][32] = { 0 };
+        uint8_t split[4][32] = { 0 };
+        uint8_t *const serial_dest[4] = { serial[0], serial[1], serial[2], serial[3] };
+        uint8_t *const split_dest[4] = { split[0], split[1], split[2], split[3] };
+
+        calculate_rolled_midstates(header, versions, count, serial_dest, false);
+        // Repeat to catch any dependence on helper scheduling
+        for (int run = 0; run < 8; run++) {
+            calculate_rolled_midstates(header, versions, count, split_dest, true);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(serial, split, sizeof(serial));
+        }
+    }
+}
+
 TEST_CASE("Validate version mask incrementing", "[mining]")
 {
     uint32_t version = 0x20000004;
@@ -174,6 +320,7 @@ TEST_CASE("Test nonce diff checking", "[mining test_nonce][not-on-qemu]")
 {
     mining_notify notify_message;
     notify_message.prev_block_hash = "d02b10fc0d4711eae1a805af50a8a83312a2215e00017f2b0000000000000000";
+    decode_prev_block_hash(notify_message.prev_block_hash, notify_message.prev_block_hash_header, notify_message.prev_block_hash_asic);
     notify_message.version = 0x20000004;
     notify_message.target = 0x1705ae3a;
     notify_message.ntime = 0x646ff1a9;
@@ -193,6 +340,7 @@ TEST_CASE("Test nonce diff checking 2", "[mining test_nonce][not-on-qemu]")
 {
     mining_notify notify_message;
     notify_message.prev_block_hash = "0c859545a3498373a57452fac22eb7113df2a465000543520000000000000000";
+    decode_prev_block_hash(notify_message.prev_block_hash, notify_message.prev_block_hash_header, notify_message.prev_block_hash_asic);
     notify_message.version = 0x20000004;
     notify_message.target = 0x1705ae3a;
     notify_message.ntime = 0x647025b5;
@@ -236,3 +384,104 @@ TEST_CASE("Test nonce diff checking 2", "[mining test_nonce][not-on-qemu]")
     double diff = test_nonce_value(&job, nonce, rolled_version);
     TEST_ASSERT_EQUAL_INT(683, (int)diff);
 }
+
+TEST_CASE("Midstate nonce check matches full header hash", "[mining test_nonce]")
+{
+    uint8_t prev_block_hash[32];
+    uint8_t merkle_root[32];
+    hex2bin("d02b10fc0d4711eae1a805af50a8a83312a2215e00017f2b0000000000000000", prev_block_hash, 32);
+    reverse_endianness_per_word(prev_block_hash);
+    hex2bin("6d0359c451434605c52a5a9ce074340be47c2c63840731f9edf1db3f26b1cdd9", merkle_root, 32);
+
+    bm_job job = { 0 };
+    construct_bm_job_header(0x20000004, prev_block_hash, merkle_root, 0x646ff1a9, 0x1705ae3a, 0x1fffe000, 1000, &job);
+    TEST_ASSERT_EQUAL(4, job.num_midstates);
+
+    // The job's own versions take the midstate path, the last one the full header path
+    uint32_t versions[5] = { job.version };
+    for (int i = 1; i < 4; i++) {
+        versions[i] = increment_bitmask(versions[i - 1], job.version_mask);
+    }
+    versions[4] = 0x20ffe004;
+
+    for (int v = 0; v < 5; v++) {
+        for (uint32_t nonce = 0x276E8940; nonce < 0x276E8950; nonce++) {
+            uint8_t header[80];
+            memcpy(header, &versions[v], 4);
+            memcpy(header + 4, prev_block_hash, 32);
+            memcpy(header + 36, merkle_root, 32);
+            memcpy(header + 68, &job.ntime, 4);
+            memcpy(header + 72, &job.target, 4);
+            memcpy(header + 76, &nonce, 4);
+            uint8_t hash[32];
+            double_sha256_bin(header, 80, hash);
+
+            TEST_ASSERT_EQUAL_DOUBLE(hash_to_pdiff(hash), test_nonce_value(&job, nonce, versions[v]));
+        }
+    }
+}
+
+TEST_CASE("Nonce check early-out below minimum difficulty", "[mining test_nonce]")
+{
+    mining_notify notify_message;
+    notify_message.prev_block_hash = "d02b10fc0d4711eae1a805af50a8a83312a2215e00017f2b0000000000000000";
+    decode_prev_block_hash(notify_message.prev_block_hash, notify_message.prev_block_hash_header, notify_message.prev_block_hash_asic);
+    notify_message.version = 0x20000004;
+    notify_message.target = 0x1705ae3a;
+    notify_message.ntime = 0x646ff1a9;
+    uint8_t merkle_root[32];
+    hex2bin("6d0359c451434605c52a5a9ce074340be47c2c63840731f9edf1db3f26b1cdd9", merkle_root, 32);
+    bm_job job = { 0 };
+    construct_bm_job(&notify_message, merkle_root, 0, 1000, &job);
+
+    uint32_t nonce = 0x276E8947;
+    double diff = test_nonce_value(&job, nonce, job.version);
+    TEST_ASSERT_EQUAL_INT(18, (int)diff);
+
+    TEST_ASSERT_EQUAL_DOUBLE(diff, test_nonce_value_min(&job, nonce, job.version, 0));
+    TEST_ASSERT_EQUAL_DOUBLE(diff, test_nonce_value_min(&job, nonce, job.version, 16));
+    TEST_ASSERT_EQUAL_DOUBLE(diff, test_nonce_value_min(&job, nonce, job.version, diff));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, test_nonce_value_min(&job, nonce, job.version, 1000));
+}
+
+TEST_CASE("Difficulty to target round trip", "[mining]")
+{
+    uint8_t target[32];
+
+    // Difficulty 1 is 0x00000000ffff0000...0000 (big-endian)
+    pdiff_to_target(1.0, target);
+    uint8_t diff1[32] = {0};
+    diff1[26] = 0xff;
+    diff1[27] = 0xff;
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(diff1, target, 32);
+
+    const double difficulties[] = { 0.5, 1.0, 512.0, 698.49, 65536.0, 1.5e6, 1e12 };
+    for (int i = 0; i < sizeof(difficulties) / sizeof(difficulties[0]); i++) {
+        pdiff_to_target(difficulties[i], target);
+        TEST_ASSERT_DOUBLE_WITHIN(difficulties[i] * 1e-9, difficulties[i], hash_to_pdiff(target));
+    }
+}
+
+TEST_CASE("Difficulty for a share rate", "[mining]")
+{
+    // 1 TH/s at 20 shares per minute
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 698.49, difficulty_for_share_rate(1000.0f, 20.0f));
+    // Doubling the share rate halves the difficulty
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 349.25, difficulty_for_share_rate(1000.0f, 40.0f));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, difficulty_for_share_rate(0.0f, 20.0f));
+    TEST_ASSERT_EQUAL_DOUBLE(0.0, difficulty_for_share_rate(1000.0f, 0.0f));
+}
+
+TEST_CASE("ntime rolling follows the time since the notify", "[mining]")
+{
+    const uint32_t ntime = 0x64658bd8;
+    const int64_t received = 5000000;
+
+    TEST_ASSERT_EQUAL_UINT32(ntime + NTIME_ROLL_ALLOWANCE_S, ntime_roll_limit(ntime, received, received));
+    // A burst of jobs within the same second can't run ahead
+    TEST_ASSERT_EQUAL_UINT32(ntime + NTIME_ROLL_ALLOWANCE_S, ntime_roll_limit(ntime, received, received + 999999));
+    TEST_ASSERT_EQUAL_UINT32(ntime + 1 + NTIME_ROLL_ALLOWANCE_S, ntime_roll_limit(ntime, received, received + 1000000));
+    TEST_ASSERT_EQUAL_UINT32(ntime + 90 + NTIME_ROLL_ALLOWANCE_S, ntime_roll_limit(ntime, received, received + 90500000));
+    // Clock readings before the notify never widen the bound
+    TEST_ASSERT_EQUAL_UINT32(ntime + NTIME_ROLL_ALLOWANCE_S, ntime_roll_limit(ntime, received, 0));
+}
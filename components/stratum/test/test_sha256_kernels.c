@@ -0,0 +1,133 @@
+#include "unity.h"
+#include "sha256_kernels.h"
+#include "utils.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+static void fill_pattern(uint8_t *buf, size_t len, uint8_t seed)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed + i * 31);
+    }
+}
+
+TEST_CASE("sha256d_80 hashes the genesis block header", "[sha256]")
+{
+    uint8_t header[80];
+    hex2bin("01000000000000000000000000000000000000000000000000000000000000000000000"
+            "03ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a29ab5f49"
+            "ffff001d1dac2b7c", header, 80);
+
+    uint8_t hash[32];
+    sha256d_80(header, hash);
+
+    char hash_hex[65];
+    bin2hex(hash, 32, hash_hex, sizeof(hash_hex));
+    TEST_ASSERT_EQUAL_STRING("6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000", hash_hex);
+}
+
+TEST_CASE("sha256d_80 and sha256d_64 match double_sha256_bin", "[sha256]")
+{
+    uint8_t data[80];
+    uint8_t expected[32];
+    uint8_t hash[32];
+
+    for (uint8_t seed = 0; seed < 8; seed++) {
+        fill_pattern(data, sizeof(data), seed);
+
+        double_sha256_bin(data, 80, expected);
+        sha256d_80(data, hash);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, hash, 32);
+
+        double_sha256_bin(data, 64, expected);
+        sha256d_64(data, hash);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, hash, 32);
+    }
+}
+
+TEST_CASE("sha256d_64 can hash in place", "[sha256]")
+{
+    uint8_t data[64];
+    uint8_t expected[32];
+    fill_pattern(data, sizeof(data), 7);
+
+    double_sha256_bin(data, 64, expected);
+    sha256d_64(data, data);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, data, 32);
+}
+
+TEST_CASE("sha256_midstate_64 matches midstate_sha256_bin", "[sha256]")
+{
+    uint8_t data[64];
+    uint8_t expected[32];
+    uint8_t midstate[32];
+
+    for (uint8_t seed = 0; seed < 8; seed++) {
+        fill_pattern(data, sizeof(data), seed);
+        midstate_sha256_bin(data, 64, expected);
+        sha256_midstate_64(data, midstate);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, midstate, 32);
+    }
+}
+
+TEST_CASE("sha256_midstates_64_rolled matches per-version midstates", "[sha256]")
+{
+    uint8_t data[64];
+    fill_pattern(data, sizeof(data), 3);
+    uint32_t versions[4] = { 0x20000004, 0x20002004, 0x20004004, 0x20006004 };
+
+    uint8_t out[4][32];
+    uint8_t *const dest[4] = { out[0], out[1], out[2], out[3] };
+    sha256_midstates_64_rolled(data, versions, 4, dest);
+
+    for (int v = 0; v < 4; v++) {
+        uint8_t midstate[32];
+        uint8_t expected[32];
+        memcpy(data, &versions[v], 4);
+        sha256_midstate_64(data, midstate);
+        reverse_32bit_words(midstate, expected);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out[v], 32);
+    }
+}
+
+#define SHA256_BENCH_ITERATIONS 2000
+
+TEST_CASE("SHA-256 kernel throughput", "[sha256][bench]")
+{
+    uint8_t data[80];
+    uint8_t hash[32];
+    fill_pattern(data, sizeof(data), 1);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SHA256_BENCH_ITERATIONS; i++) {
+        data[76] = i;
+        sha256d_80(data, hash);
+    }
+    int64_t sha256d_80_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < SHA256_BENCH_ITERATIONS; i++) {
+        sha256d_64(data, data);
+    }
+    int64_t sha256d_64_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < SHA256_BENCH_ITERATIONS; i++) {
+        data[0] = i;
+        sha256_midstate_64(data, hash);
+    }
+    int64_t midstate_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < SHA256_BENCH_ITERATIONS; i++) {
+        data[76] = i;
+        double_sha256_bin(data, 80, hash);
+    }
+    int64_t generic_80_us = esp_timer_get_time() - start;
+
+    printf("sha256d_80:         %lld hashes/s\n", SHA256_BENCH_ITERATIONS * 1000000LL / (sha256d_80_us + 1));
+    printf("sha256d_64:         %lld hashes/s\n", SHA256_BENCH_ITERATIONS * 1000000LL / (sha256d_64_us + 1));
+    printf("sha256_midstate_64: %lld hashes/s\n", SHA256_BENCH_ITERATIONS * 1000000LL / (midstate_us + 1));
+    printf("double_sha256_bin:  %lld hashes/s (80 bytes, generic)\n", SHA256_BENCH_ITERATIONS * 1000000LL / (generic_80_us + 1));
+}
@@ -0,0 +1,54 @@
+#include "unity.h"
+#include "share_filter.h"
+#include <stdio.h>
+
+TEST_CASE("Share filter suppresses a repeated share", "[share_filter]")
+{
+    static share_filter filter;
+    share_filter_init(&filter);
+
+    uint64_t key = share_filter_key("1b", "00000001", 0x64658bd8, 0x2a6b1f00, 0x00002000);
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, key));
+    TEST_ASSERT_TRUE(share_filter_check_and_add(&filter, key));
+
+    // Any differing field makes a different share
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1c", "00000001", 0x64658bd8, 0x2a6b1f00, 0x00002000)));
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000002", 0x64658bd8, 0x2a6b1f00, 0x00002000)));
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000001", 0x64658bd8, 0x2a6b1f01, 0x00002000)));
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000001", 0x64658bd8, 0x2a6b1f00, 0x00004000)));
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1", "b00000001", 0x64658bd8, 0x2a6b1f00, 0x00002000)));
+}
+
+TEST_CASE("Share filter keeps shares that differ only in ntime", "[share_filter]")
+{
+    static share_filter filter;
+    share_filter_init(&filter);
+
+    // Rolled ntime jobs reuse the job id and extranonce2 of their base job
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000001", 0x64658bd8, 0x2a6b1f00, 0x00002000)));
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000001", 0x64658bd9, 0x2a6b1f00, 0x00002000)));
+    TEST_ASSERT_TRUE(share_filter_check_and_add(&filter, share_filter_key("1b", "00000001", 0x64658bd9, 0x2a6b1f00, 0x00002000)));
+}
+
+TEST_CASE("Share filter forgets the oldest shares once full", "[share_filter]")
+{
+    static share_filter filter;
+    share_filter_init(&filter);
+    char extranonce2[9];
+
+    // Several times the capacity, so eviction runs through many probe chains
+    for (uint32_t i = 0; i < SHARE_FILTER_CAPACITY * 4; i++) {
+        snprintf(extranonce2, sizeof(extranonce2), "%08x", (unsigned)i);
+        TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("7", extranonce2, 0x64658bd8, i * 2654435761u, 0)));
+
+        // Everything still inside the window is remembered
+        uint32_t oldest = i + 1 > SHARE_FILTER_CAPACITY ? i + 1 - SHARE_FILTER_CAPACITY : 0;
+        for (uint32_t j = oldest; j <= i; j += 17) {
+            snprintf(extranonce2, sizeof(extranonce2), "%08x", (unsigned)j);
+            TEST_ASSERT_TRUE(share_filter_check_and_add(&filter, share_filter_key("7", extranonce2, 0x64658bd8, j * 2654435761u, 0)));
+        }
+    }
+
+    snprintf(extranonce2, sizeof(extranonce2), "%08x", 0u);
+    TEST_ASSERT_FALSE(share_filter_check_and_add(&filter, share_filter_key("7", extranonce2, 0x64658bd8, 0, 0)));
+}
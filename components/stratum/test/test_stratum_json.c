@@ -1,6 +1,8 @@
 #include "unity.h"
 #include "stratum_api.h"
 
+#include <string.h>
+
 TEST_CASE("Parse stratum method", "[stratum]")
 {
     StratumApiV1Message stratum_api_v1_message = {};
@@ -95,6 +97,14 @@ TEST_CASE("Parse stratum notify params", "[mining.notify]")
     TEST_ASSERT_EQUAL_UINT32(0x20000004, stratum_api_v1_message.mining_notification->version);
     TEST_ASSERT_EQUAL_UINT32(0x1705c739, stratum_api_v1_message.mining_notification->target);
     TEST_ASSERT_EQUAL_UINT32(0x64495522, stratum_api_v1_message.mining_notification->ntime);
+    TEST_ASSERT_EQUAL(strlen(stratum_api_v1_message.mining_notification->coinbase_1) / 2, stratum_api_v1_message.mining_notification->coinbase_1_len);
+    TEST_ASSERT_EQUAL(strlen(stratum_api_v1_message.mining_notification->coinbase_2) / 2, stratum_api_v1_message.mining_notification->coinbase_2_len);
+    TEST_ASSERT_EQUAL_UINT8(0x01, stratum_api_v1_message.mining_notification->coinbase_1_bin[0]);
+    TEST_ASSERT_EQUAL_UINT8(0x41, stratum_api_v1_message.mining_notification->coinbase_2_bin[0]);
+    // prev_block_hash words are byte swapped for the header, and the word order reversed for the ASIC
+    uint8_t expected_prev_header[4] = { 0x48, 0x9a, 0x4b, 0xef };
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_prev_header, stratum_api_v1_message.mining_notification->prev_block_hash_header, 4);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected_prev_header, stratum_api_v1_message.mining_notification->prev_block_hash_asic + 28, 4);
 }
 
 TEST_CASE("Test mining.subcribe result parsing", "[mining.subscribe]")
@@ -321,3 +331,18 @@ TEST_CASE("Parse stratum configure result", "[stratum]")
     TEST_ASSERT_TRUE(stratum_api_v1_message.response_success);
     TEST_ASSERT_EQUAL_HEX32(0x1fffe000, stratum_api_v1_message.version_mask);
 }
+
+TEST_CASE("Format coalesced mining.submit messages", "[stratum]")
+{
+    char buf[512];
+    int len = STRATUM_V1_format_submit(buf, sizeof(buf), 5, "bc1q.worker", "1b", "00000001", 0x64658bd8, 0x2a6b1f00, 0x00002000);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":5,\"method\":\"mining.submit\",\"params\":[\"bc1q.worker\",\"1b\",\"00000001\",\"64658bd8\",\"2a6b1f00\",\"00002000\"]}\n", buf);
+    TEST_ASSERT_EQUAL(strlen(buf), len);
+
+    int len2 = STRATUM_V1_format_submit(buf + len, sizeof(buf) - len, 6, "bc1q.worker", "1c", "00000002", 0x64658bd9, 0x00000001, 0);
+    TEST_ASSERT_GREATER_THAN(0, len2);
+    TEST_ASSERT_EQUAL(len + len2, strlen(buf));
+    TEST_ASSERT_EQUAL_STRING_LEN("{\"id\":6,", buf + len, 8);
+
+    TEST_ASSERT_EQUAL(-1, STRATUM_V1_format_submit(buf, 32, 7, "bc1q.worker", "1d", "00000003", 0, 0, 0));
+}
@@ -0,0 +1,94 @@
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#include "work_split.h"
+
+#if defined(ESP_PLATFORM) && !CONFIG_FREERTOS_UNICORE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+// Same priority as the stratum miner task, so the helper preempts anything
+// lower on the other core while a split is in flight
+#define WORK_SPLIT_TASK_PRIORITY 20
+#define WORK_SPLIT_TASK_STACK 4096
+
+static const char *TAG = "work_split";
+
+static TaskHandle_t helper_task;
+static SemaphoreHandle_t split_lock;
+static SemaphoreHandle_t helper_done;
+static work_split_fn helper_fn;
+static void *helper_arg;
+
+static void work_split_helper(void *pvParameters)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        helper_fn(helper_arg);
+        xSemaphoreGive(helper_done);
+    }
+}
+
+bool work_split_init(void)
+{
+    if (helper_task) return true;
+
+    if (!split_lock) split_lock = xSemaphoreCreateMutex();
+    if (!helper_done) helper_done = xSemaphoreCreateBinary();
+    if (!split_lock || !helper_done) {
+        ESP_LOGE(TAG, "Failed to create work split semaphores");
+        return false;
+    }
+
+    // Unpinned tasks can share a core, where a split only adds a context switch
+    BaseType_t caller_core = xTaskGetCoreID(NULL);
+    if (caller_core == tskNO_AFFINITY) {
+        ESP_LOGW(TAG, "Calling task is not pinned to a core, not splitting work");
+        return false;
+    }
+    BaseType_t helper_core = caller_core == 0 ? 1 : 0;
+
+    if (xTaskCreatePinnedToCore(work_split_helper, "work split", WORK_SPLIT_TASK_STACK, NULL, WORK_SPLIT_TASK_PRIORITY, &helper_task, helper_core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create work split task");
+        helper_task = NULL;
+        return false;
+    }
+    return true;
+}
+
+void work_split_run(work_split_fn fn_a, void *arg_a, work_split_fn fn_b, void *arg_b)
+{
+    if (!helper_task || xSemaphoreTake(split_lock, 0) != pdTRUE) {
+        fn_a(arg_a);
+        fn_b(arg_b);
+        return;
+    }
+
+    helper_fn = fn_b;
+    helper_arg = arg_b;
+    xTaskNotifyGive(helper_task);
+
+    fn_a(arg_a);
+
+    xSemaphoreTake(helper_done, portMAX_DELAY);
+    xSemaphoreGive(split_lock);
+}
+
+#else
+
+bool work_split_init(void)
+{
+    return false;
+}
+
+void work_split_run(work_split_fn fn_a, void *arg_a, work_split_fn fn_b, void *arg_b)
+{
+    fn_a(arg_a);
+    fn_b(arg_b);
+}
+
+#endif
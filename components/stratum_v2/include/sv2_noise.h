@@ -26,6 +26,12 @@ int sv2_noise_handshake(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
 int sv2_noise_send(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
                    const uint8_t *frame, int frame_len);
 
+// Send several back-to-back plaintext SV2 frames, each encrypted as by
+// sv2_noise_send(), in a single transport write.
+// Returns 0 on success, -1 on error.
+int sv2_noise_send_frames(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
+                          const uint8_t *frames, int frames_len);
+
 // Receive and decrypt an SV2 frame via Noise.
 // hdr_out receives the 6-byte decrypted frame header.
 // payload_out receives the decrypted payload (up to max_payload_len bytes).
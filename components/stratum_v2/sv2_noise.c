@@ -494,6 +494,31 @@ int sv2_noise_handshake(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
     return 0;
 }
 
+// Encrypted size of a plaintext frame: the 22-byte encrypted header plus, when
+// there is a payload, the payload and its 16-byte tag
+static int noise_encrypted_len(int payload_len)
+{
+    return payload_len > 0 ? 22 + payload_len + 16 : 22;
+}
+
+// Encrypt one plaintext frame into out[0..noise_encrypted_len(payload_len)).
+// The header and payload use separate Noise nonces but are just consecutive
+// bytes on the wire, so the receiver, which reads the 22-byte header first and
+// then the payload, is unaffected by them leaving in a single write.
+static int noise_encrypt_frame(sv2_noise_ctx_t *ctx, const uint8_t *frame, int payload_len, uint8_t *out)
+{
+    if (noise_encrypt(ctx->send_key, ctx->send_nonce++, NULL, 0,
+                      frame, SV2_FRAME_HEADER_SIZE, out) != 0) {
+        return -1;
+    }
+    if (payload_len > 0 &&
+        noise_encrypt(ctx->send_key, ctx->send_nonce++, NULL, 0,
+                      frame + SV2_FRAME_HEADER_SIZE, payload_len, out + 22) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
 int sv2_noise_send(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
                    const uint8_t *frame, int frame_len)
 {
@@ -506,8 +531,7 @@ int sv2_noise_send(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
     // Header-only frame: encrypt (6 -> 22 bytes) and send directly off the stack.
     if (payload_len <= 0) {
         uint8_t enc_hdr[22];
-        if (noise_encrypt(ctx->send_key, ctx->send_nonce++, NULL, 0,
-                          frame, SV2_FRAME_HEADER_SIZE, enc_hdr) != 0) {
+        if (noise_encrypt_frame(ctx, frame, 0, enc_hdr) != 0) {
             return -1;
         }
         return noise_send_all(transport, enc_hdr, 22);
@@ -515,27 +539,60 @@ int sv2_noise_send(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
 
     // Build the encrypted header and payload contiguously and send them in a
     // single write, so a frame leaves as one TCP segment instead of a header
-    // segment followed by a payload segment. The two parts use separate Noise
-    // nonces but are just consecutive bytes on the wire, so the receiver, which
-    // reads the 22-byte header first and then the payload, is unaffected.
-    int total_len = 22 + payload_len + 16;
+    // segment followed by a payload segment.
+    int total_len = noise_encrypted_len(payload_len);
     uint8_t *out = malloc(total_len);
     if (!out) return -1;
 
-    // Encrypt header (nonce N) into out[0..21]
-    if (noise_encrypt(ctx->send_key, ctx->send_nonce++, NULL, 0,
-                      frame, SV2_FRAME_HEADER_SIZE, out) != 0) {
+    if (noise_encrypt_frame(ctx, frame, payload_len, out) != 0) {
         free(out);
         return -1;
     }
 
-    // Encrypt payload (nonce N+1) into out[22..]
-    if (noise_encrypt(ctx->send_key, ctx->send_nonce++, NULL, 0,
-                      frame + SV2_FRAME_HEADER_SIZE, payload_len, out + 22) != 0) {
-        free(out);
+    int ret = noise_send_all(transport, out, total_len);
+    free(out);
+    return ret;
+}
+
+int sv2_noise_send_frames(sv2_noise_ctx_t *ctx, esp_transport_handle_t transport,
+                          const uint8_t *frames, int frames_len)
+{
+    if (!ctx || !ctx->handshake_complete) {
         return -1;
     }
 
+    // Walk the frame headers once to size the output and reject a malformed batch
+    // before any Noise nonce is consumed
+    int total_len = 0;
+    for (int offset = 0; offset < frames_len;) {
+        sv2_frame_header_t hdr;
+        if (frames_len - offset < SV2_FRAME_HEADER_SIZE ||
+            sv2_parse_frame_header(frames + offset, &hdr) != 0 ||
+            hdr.msg_length > (uint32_t)(frames_len - offset - SV2_FRAME_HEADER_SIZE)) {
+            return -1;
+        }
+        total_len += noise_encrypted_len(hdr.msg_length);
+        offset += SV2_FRAME_HEADER_SIZE + hdr.msg_length;
+    }
+    if (total_len == 0) {
+        return 0;
+    }
+
+    uint8_t *out = malloc(total_len);
+    if (!out) return -1;
+
+    int out_len = 0;
+    for (int offset = 0; offset < frames_len;) {
+        sv2_frame_header_t hdr;
+        sv2_parse_frame_header(frames + offset, &hdr);
+        if (noise_encrypt_frame(ctx, frames + offset, hdr.msg_length, out + out_len) != 0) {
+            free(out);
+            return -1;
+        }
+        out_len += noise_encrypted_len(hdr.msg_length);
+        offset += SV2_FRAME_HEADER_SIZE + hdr.msg_length;
+    }
+
     int ret = noise_send_all(transport, out, total_len);
     free(out);
     return ret;
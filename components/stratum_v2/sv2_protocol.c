@@ -1,5 +1,6 @@
 #include "sv2_protocol.h"
 #include "utils.h"
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
@@ -210,6 +211,29 @@ int sv2_build_submit_shares_standard(uint8_t *buf, size_t buf_len,
     return total;
 }
 
+int sv2_build_update_channel(uint8_t *buf, size_t buf_len,
+                             uint32_t channel_id, float nominal_hash_rate,
+                             const uint8_t max_target[32])
+{
+    // Payload: channel_id(4) + nominal_hash_rate(4) + maximum_target(32) = 40 bytes
+    int payload_len = 40;
+    int total = SV2_FRAME_HEADER_SIZE + payload_len;
+    if ((size_t)total > buf_len) return -1;
+
+    sv2_encode_frame_header(buf, SV2_CHANNEL_MSG_FLAG, SV2_MSG_UPDATE_CHANNEL, (uint32_t)payload_len);
+
+    uint8_t *payload = buf + SV2_FRAME_HEADER_SIZE;
+    write_u32_le(payload, channel_id);
+
+    uint32_t f_bits;
+    memcpy(&f_bits, &nominal_hash_rate, 4);
+    write_u32_le(payload + 4, f_bits);
+
+    memcpy(payload + 8, max_target, 32);
+
+    return total;
+}
+
 // --- Message parsers ---
 
 int sv2_parse_setup_connection_success(const uint8_t *payload, uint32_t len,
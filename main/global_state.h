@@ -9,11 +9,16 @@
 #include "power_management_task.h"
 #include "hashrate_monitor_task.h"
 #include "mining.h"
+#include "job_table.h"
+#include "latency_histogram.h"
 #include "coinbase_decoder.h"
 #include "work_queue.h"
 #include "device_config.h"
 #include "display.h"
 #include "scoreboard.h"
+#include "share_submit_task.h"
+#include "core_stats.h"
+#include "difficulty_tuner_task.h"
 #include "esp_transport.h"
 
 typedef enum {
@@ -43,6 +48,7 @@ typedef struct {
     uint16_t tls;
     char * cert;
     bool decode_coinbase_tx;
+    bool ntime_roll;
     uint16_t sv2_channel_type;
     char * sv2_authority_pubkey;
 } PoolConfig;
@@ -53,6 +59,12 @@ typedef struct {
 #define MAX_BLOCK_SIGNAL_LEN 16
 #define MAX_POOLS 8
 
+// Submit-to-ack latency of one pool, reset on every new connection to it
+typedef struct {
+    latency_histogram histogram;
+    stratum_protocol_t protocol; // of the connection the samples came from
+} PoolLatency;
+
 typedef struct {
     char message[64];
     uint32_t count;
@@ -69,6 +81,8 @@ typedef struct
     uint64_t shares_accepted;
     uint64_t shares_rejected;
     uint64_t work_received;
+    uint64_t jobs_built;
+    uint64_t jobs_ntime_rolled;
     RejectedReasonStat rejected_reason_stats[10];
     int rejected_reason_stats_count;
     int screen_page;
@@ -93,6 +107,7 @@ typedef struct
     bool is_using_fallback;
     float response_time;
     uint16_t response_share_batch;
+    PoolLatency submit_latency[MAX_POOLS];
     float process_time;
     float cpu_usage;
     char pool_connection_info[64];
@@ -139,12 +154,18 @@ typedef struct
 {
     // ASIC may not return the nonce in the same order as the jobs were sent
     // it also may return a previous nonce under some circumstances
-    // so we keep a list of jobs indexed by the job id
-    bm_job **active_jobs;
+    // so we keep a list of jobs indexed by the job id.
+    // BM_JOB_POOL_SIZE slots published by send_work and read lock-free by the result path
+    job_table jobs;
     // Current job to be processed (replaces ASIC_jobs_queue)
     bm_job *current_job;
     //semaphone
     SemaphoreHandle_t semaphore;
+    // Result path intake: UART event wake-ups and time from UART read to nonce validation
+    float rx_wakeups_per_s;
+    uint32_t nonces_validated;
+    float nonce_intake_latency_us;
+    uint32_t nonce_intake_latency_max_us;
 } AsicTaskModule;
 
 typedef struct
@@ -158,13 +179,13 @@ typedef struct
     PowerManagementModule POWER_MANAGEMENT_MODULE;
     SelfTestModule SELF_TEST_MODULE;
     HashrateMonitorModule HASHRATE_MONITOR_MODULE;
+    ShareSubmitModule SHARE_SUBMIT_MODULE;
+    CoreStatsModule CORE_STATS_MODULE;
+    DifficultyTunerModule DIFFICULTY_TUNER_MODULE;
 
     char * extranonce_str;
     int extranonce_2_len;
 
-    uint8_t * valid_jobs;
-    pthread_mutex_t valid_jobs_lock;
-
     double pool_difficulty;
     bool new_set_mining_difficulty_msg;
     uint32_t version_mask;
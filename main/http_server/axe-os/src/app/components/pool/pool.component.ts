@@ -96,6 +96,7 @@ export class PoolComponent implements OnInit {
             stratumTLS: 0,
             stratumCert: '',
             stratumDecodeCoinbase: true,
+            stratumNtimeRoll: false,
             stratumV2ChannelType: 'extended',
             stratumV2AuthorityPubkey: ''
           });
@@ -115,6 +116,7 @@ export class PoolComponent implements OnInit {
             stratumTLS: 0,
             stratumCert: '',
             stratumDecodeCoinbase: true,
+            stratumNtimeRoll: false,
             stratumV2ChannelType: 'extended',
             stratumV2AuthorityPubkey: ''
           });
@@ -147,6 +149,7 @@ export class PoolComponent implements OnInit {
             stratumTLS: [pool.stratumTLS || 0],
             stratumCert: [pool.stratumCert || ''],
             stratumDecodeCoinbase: [pool.stratumDecodeCoinbase == true, [Validators.required]],
+            stratumNtimeRoll: [pool.stratumNtimeRoll == true],
             stratumV2ChannelType: [pool.stratumV2ChannelType || 'extended'],
             stratumV2AuthorityPubkey: [pool.stratumV2AuthorityPubkey || '', [this.base58Validator()]]
           });
@@ -257,6 +260,7 @@ export class PoolComponent implements OnInit {
         stratumTLS: [0],
         stratumCert: [''],
         stratumDecodeCoinbase: [true, [Validators.required]],
+        stratumNtimeRoll: [false],
         stratumV2ChannelType: ['extended'],
         stratumV2AuthorityPubkey: ['', [this.base58Validator()]]
       });
@@ -92,6 +92,9 @@ export class SystemApiService {
           { message: "Above target", count: 8 },
           { message: "Duplicate share", count: 2 }
         ],
+        submitLatency: [
+          { pool: 0, protocol: "SV1" as any, count: 11, p50: 48, p90: 64, p99: 96, max: 91.3 }
+        ],
         uptimeSeconds: 38,
         smallCoreCount: 672,
         ASICModel: "BM1370" as any,
@@ -110,6 +113,7 @@ export class SystemApiService {
             stratumTLS: 0,
             stratumCert: "",
             stratumDecodeCoinbase: true,
+            stratumNtimeRoll: false,
             stratumV2ChannelType: "extended" as const,
             stratumV2AuthorityPubkey: ""
           },
@@ -125,6 +129,7 @@ export class SystemApiService {
             stratumTLS: 0,
             stratumCert: "",
             stratumDecodeCoinbase: true,
+            stratumNtimeRoll: false,
             stratumV2ChannelType: "extended" as const,
             stratumV2AuthorityPubkey: ""
           }
@@ -154,6 +159,27 @@ export class SystemApiService {
         poolDifficulty: 1000,
         responseTime: 10,
         responseShareBatch: 1,
+        jobsBuilt: 0,
+        jobsNtimeRolled: 0,
+        shareQueueDepth: 0,
+        shareQueueHighWater: 1,
+        sharesDroppedFull: 0,
+        sharesDroppedStale: 0,
+        shareSendErrors: 0,
+        sharesDuplicate: 0,
+        shareWrites: 0,
+        shareSubmitLatency: 1.2,
+        shareSubmitLatencyMax: 4.5,
+        blocksSubmitted: 0,
+        blocksDropped: 0,
+        blockSubmitLatency: 0,
+        asicRxResyncs: 0,
+        asicRxBytesSkipped: 0,
+        asicRxOverflows: 0,
+        asicRxBufferFull: 0,
+        asicRxWakeups: 12.5,
+        nonceIntakeLatency: 85,
+        nonceIntakeLatencyMax: 420,
         isUsingFallbackStratum: 0,
         poolConnectionInfo: "IPv4 (TLS)",
         frequency: 485,
@@ -176,6 +202,8 @@ export class SystemApiService {
         manualFanSpeed: 70,
         temptarget: 60,
         statsFrequency: 30,
+        targetSharesPerMinute: 0,
+        suggestedDifficulty: 0,
         fanrpm: 3583,
         fan2rpm: 4146,
 
@@ -195,6 +223,9 @@ export class SystemApiService {
             errorCount: 4,
           }],
           hashrate: 441.2579,
+          readbackLatency: 2.4,
+          readbackLatencyMax: 6.1,
+          readbackTimeouts: 0,
         },
         blockFound: 1,
         showNewBlock: true,
@@ -272,7 +303,8 @@ export class SystemApiService {
     return of({
       currentTimestamp: 61125,
       labels: columnList,
-      statistics: statisticsList
+      statistics: statisticsList,
+      submitLatency: []
     });
   }
 
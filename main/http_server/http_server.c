@@ -710,6 +710,7 @@ static bool validate_pool_json(const cJSON *pool_item, int i) {
     if (!validate_number_range(cJSON_GetObjectItem(pool_item, "stratumTLS"), "stratumTLS", 0, 2, i)) return false;
     if (!validate_string_field(cJSON_GetObjectItem(pool_item, "stratumCert"), "stratumCert", 3000, i)) return false;
     if (!validate_bool_or_num(cJSON_GetObjectItem(pool_item, "stratumDecodeCoinbase"), "stratumDecodeCoinbase", i)) return false;
+    if (!validate_bool_or_num(cJSON_GetObjectItem(pool_item, "stratumNtimeRoll"), "stratumNtimeRoll", i)) return false;
 
     cJSON *v2chan = cJSON_GetObjectItem(pool_item, "stratumV2ChannelType");
     if (v2chan) {
@@ -762,6 +763,7 @@ static void update_pool_nvs(const cJSON *pool_item, int i) {
     add_number_field_default(p_obj, pool_item, "stratumTLS", 0);
     add_string_field_default(p_obj, pool_item, "stratumCert", "");
     add_bool_field_default(p_obj, pool_item, "stratumDecodeCoinbase", true);
+    add_bool_field_default(p_obj, pool_item, "stratumNtimeRoll", false);
     add_string_field_default(p_obj, pool_item, "stratumV2ChannelType", SV2_CHANNEL_TYPE_EXTENDED);
     add_string_field_default(p_obj, pool_item, "stratumV2AuthorityPubkey", "");
 
@@ -1439,6 +1441,7 @@ static esp_err_t GET_system_statistics(httpd_req_t * req)
     cJSON_AddItemToArray(labelArray, cJSON_CreateString(STATS_LABEL_TIMESTAMP));
 
     cJSON_AddItemToObject(root, "labels", labelArray);
+    cJSON_AddItemToObject(root, "submitLatency", system_api_get_submit_latency_json(GLOBAL_STATE));
 
     cJSON * statsArray = cJSON_AddArrayToObject(root, "statistics");
     struct StatisticsData statsData;
@@ -1476,6 +1479,33 @@ static esp_err_t GET_system_statistics(httpd_req_t * req)
     return res;
 }
 
+static esp_err_t GET_asic_cores(httpd_req_t * req)
+{
+    if (is_network_allowed(req) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Unauthorized");
+    }
+
+    httpd_resp_set_type(req, "application/json");
+
+    // Set CORS headers
+    if (set_cors_headers(req) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
+    }
+
+    cJSON * root = system_api_get_core_stats_json(GLOBAL_STATE);
+    if (root == NULL) {
+        httpd_resp_send_500(req);
+        return ESP_OK;
+    }
+
+    esp_err_t res = HTTP_send_json(req, root, &api_common_prebuffer_len);
+
+    cJSON_Delete(root);
+
+    return res;
+}
+
 static esp_err_t GET_scoreboard(httpd_req_t * req)
 {
     if (is_network_allowed(req) != ESP_OK) {
@@ -1719,7 +1749,7 @@ esp_err_t start_rest_server(void * pvParameters)
     config.uri_match_fn = httpd_uri_match_wildcard;
     config.stack_size = 8192;
     config.max_open_sockets = 20;
-    config.max_uri_handlers = 25;
+    config.max_uri_handlers = 26;
     config.close_fn = websocket_close_fn;
     config.lru_purge_enable = true;
 
@@ -1766,6 +1796,15 @@ esp_err_t start_rest_server(void * pvParameters)
     };
     httpd_register_uri_handler(server, &system_asic_get_uri);
 
+    /* URI handler for fetching per-core nonce counters */
+    httpd_uri_t asic_cores_get_uri = {
+        .uri = "/api/system/asic/cores",
+        .method = HTTP_GET,
+        .handler = GET_asic_cores,
+        .user_ctx = rest_context
+    };
+    httpd_register_uri_handler(server, &asic_cores_get_uri);
+
     /* URI handler for fetching system statistic values */
     httpd_uri_t system_statistics_get_uri = {
         .uri = "/api/system/statistics", 
@@ -13,6 +13,8 @@
 #include "cjson_utils.h"
 #include "statistics_task.h"
 #include "stratum_v2_task.h"
+#include "asic_common.h"
+#include "serial.h"
 
 
 static const char *get_reset_reason_str(esp_reset_reason_t reason)
@@ -66,9 +68,34 @@ static void system_api_add_telemetry(cJSON *root, GlobalState *g) {
     cJSON_AddNumberToObject(root, "bestDiff", g->SYSTEM_MODULE.best_nonce_diff);
     cJSON_AddNumberToObject(root, "bestSessionDiff", g->SYSTEM_MODULE.best_session_nonce_diff);
     cJSON_AddNumberToObject(root, "poolDifficulty", g->pool_difficulty);
+    cJSON_AddNumberToObject(root, "suggestedDifficulty", g->DIFFICULTY_TUNER_MODULE.suggested_difficulty);
     cJSON_AddFloatToObject(root, "responseTime", g->SYSTEM_MODULE.response_time);
     cJSON_AddNumberToObject(root, "responseShareBatch", g->SYSTEM_MODULE.response_share_batch);
     cJSON_AddFloatToObject(root, "processTime", g->SYSTEM_MODULE.process_time);
+    cJSON_AddNumberToObject(root, "jobsBuilt", g->SYSTEM_MODULE.jobs_built);
+    cJSON_AddNumberToObject(root, "jobsNtimeRolled", g->SYSTEM_MODULE.jobs_ntime_rolled);
+    cJSON_AddNumberToObject(root, "shareQueueDepth", share_submit_queue_depth(g));
+    cJSON_AddNumberToObject(root, "shareQueueHighWater", g->SHARE_SUBMIT_MODULE.queue_high_water);
+    cJSON_AddNumberToObject(root, "sharesDroppedFull", g->SHARE_SUBMIT_MODULE.dropped_full);
+    cJSON_AddNumberToObject(root, "sharesDroppedStale", g->SHARE_SUBMIT_MODULE.dropped_stale);
+    cJSON_AddNumberToObject(root, "shareSendErrors", g->SHARE_SUBMIT_MODULE.send_errors);
+    cJSON_AddNumberToObject(root, "sharesDuplicate", g->SHARE_SUBMIT_MODULE.duplicates);
+    cJSON_AddNumberToObject(root, "shareWrites", g->SHARE_SUBMIT_MODULE.batches);
+    cJSON_AddFloatToObject(root, "shareSubmitLatency", g->SHARE_SUBMIT_MODULE.avg_latency_ms);
+    cJSON_AddFloatToObject(root, "shareSubmitLatencyMax", g->SHARE_SUBMIT_MODULE.max_latency_ms);
+    cJSON_AddNumberToObject(root, "blocksSubmitted", g->SHARE_SUBMIT_MODULE.blocks_sent);
+    cJSON_AddNumberToObject(root, "blocksDropped", g->SHARE_SUBMIT_MODULE.blocks_dropped);
+    cJSON_AddFloatToObject(root, "blockSubmitLatency", g->SHARE_SUBMIT_MODULE.block_latency_ms);
+
+    uint32_t rx_resyncs, rx_bytes_skipped;
+    get_asic_rx_stats(&rx_resyncs, &rx_bytes_skipped);
+    cJSON_AddNumberToObject(root, "asicRxResyncs", rx_resyncs);
+    cJSON_AddNumberToObject(root, "asicRxBytesSkipped", rx_bytes_skipped);
+    cJSON_AddNumberToObject(root, "asicRxOverflows", SERIAL_rx_overflows());
+    cJSON_AddNumberToObject(root, "asicRxBufferFull", SERIAL_rx_buffer_full());
+    cJSON_AddFloatToObject(root, "asicRxWakeups", g->ASIC_TASK_MODULE.rx_wakeups_per_s);
+    cJSON_AddFloatToObject(root, "nonceIntakeLatency", g->ASIC_TASK_MODULE.nonce_intake_latency_us);
+    cJSON_AddNumberToObject(root, "nonceIntakeLatencyMax", g->ASIC_TASK_MODULE.nonce_intake_latency_max_us);
 
     // Dynamic Block Info
     cJSON_AddNumberToObject(root, "blockFound", g->SYSTEM_MODULE.block_found);
@@ -173,6 +200,7 @@ static void system_api_add_config(cJSON *root, GlobalState *g) {
             cJSON_AddNumberToObject(p_obj, "stratumTLS", p->tls);
             cJSON_AddStringToObject(p_obj, "stratumCert", p->cert ? p->cert : "");
             cJSON_AddBoolToObject(p_obj, "stratumDecodeCoinbase", p->decode_coinbase_tx);
+            cJSON_AddBoolToObject(p_obj, "stratumNtimeRoll", p->ntime_roll);
             cJSON_AddStringToObject(p_obj, "stratumV2ChannelType", p->sv2_channel_type == SV2_CHANNEL_STANDARD ? SV2_CHANNEL_TYPE_STANDARD : SV2_CHANNEL_TYPE_EXTENDED);
             cJSON_AddStringToObject(p_obj, "stratumV2AuthorityPubkey", p->sv2_authority_pubkey ? p->sv2_authority_pubkey : "");
             
@@ -223,6 +251,7 @@ static void system_api_add_config(cJSON *root, GlobalState *g) {
     cJSON_AddNumberToObject(root, "coreVoltage", nvs_config_get_u16(NVS_CONFIG_ASIC_VOLTAGE));
     cJSON_AddFloatToObject(root, "frequency", nvs_config_get_float(NVS_CONFIG_ASIC_FREQUENCY));
     cJSON_AddNumberToObject(root, "statsFrequency", nvs_config_get_u16(NVS_CONFIG_STATISTICS_FREQUENCY));
+    cJSON_AddNumberToObject(root, "targetSharesPerMinute", nvs_config_get_u16(NVS_CONFIG_TARGET_SHARE_RATE));
     cJSON_AddNumberToObject(root, "statsLimit", MAX_STATISTICS_COUNT);
 }
 
@@ -232,6 +261,10 @@ static void system_api_add_hashrate_monitor(cJSON *root, GlobalState *g) {
     cJSON *monitor = cJSON_CreateObject();
     cJSON_AddItemToObject(root, "hashrateMonitor", monitor);
     
+    cJSON_AddFloatToObject(monitor, "readbackLatency", g->HASHRATE_MONITOR_MODULE.readback_latency_ms);
+    cJSON_AddFloatToObject(monitor, "readbackLatencyMax", g->HASHRATE_MONITOR_MODULE.readback_latency_max_ms);
+    cJSON_AddNumberToObject(monitor, "readbackTimeouts", g->HASHRATE_MONITOR_MODULE.readback_timeouts);
+
     cJSON *asics = cJSON_CreateArray();
     cJSON_AddItemToObject(monitor, "asics", asics);
 
@@ -294,6 +327,29 @@ static void system_api_add_block_info(cJSON *root, GlobalState *g) {
     }
 }
 
+cJSON* system_api_get_submit_latency_json(GlobalState *g) {
+    if (!g) return NULL;
+    cJSON *pools = cJSON_CreateArray();
+    if (pools == NULL) return NULL;
+
+    for (int i = 0; i < MAX_POOLS; i++) {
+        const PoolLatency *latency = &g->SYSTEM_MODULE.submit_latency[i];
+        if (latency->protocol == STRATUM_PROTOCOL_UNKNOWN) continue;
+
+        const latency_histogram *h = &latency->histogram;
+        cJSON *pool = cJSON_CreateObject();
+        cJSON_AddNumberToObject(pool, "pool", i);
+        cJSON_AddStringToObject(pool, "protocol", latency->protocol == STRATUM_PROTOCOL_V2 ? STRATUM_V2 : STRATUM_V1);
+        cJSON_AddNumberToObject(pool, "count", h->count);
+        cJSON_AddFloatToObject(pool, "p50", latency_histogram_percentile(h, 50) / 1000.0f);
+        cJSON_AddFloatToObject(pool, "p90", latency_histogram_percentile(h, 90) / 1000.0f);
+        cJSON_AddFloatToObject(pool, "p99", latency_histogram_percentile(h, 99) / 1000.0f);
+        cJSON_AddFloatToObject(pool, "max", h->max_us / 1000.0f);
+        cJSON_AddItemToArray(pools, pool);
+    }
+    return pools;
+}
+
 cJSON* system_api_get_full_json(GlobalState *g) {
     if (!g) return NULL;
     cJSON *root = cJSON_CreateObject();
@@ -306,6 +362,72 @@ cJSON* system_api_get_full_json(GlobalState *g) {
     // Arrays that involve global state loops (not simple addition)
     system_api_add_rejected_reasons(root, g);
     system_api_add_block_info(root, g);
+    cJSON_AddItemToObject(root, "submitLatency", system_api_get_submit_latency_json(g));
+
+    return root;
+}
+
+// A core counts as idle once the ASIC has returned enough nonces for its mean
+// per core to be meaningful and the core delivered under this share of it
+#define CORE_IDLE_MIN_MEAN_NONCES 20
+#define CORE_IDLE_FRACTION 0.1
+
+static void add_core_counters(cJSON *asic, const char *nonces_name, const char *hashrate_name,
+                              const core_counter *counters, int count, double elapsed_s)
+{
+    cJSON *nonces = cJSON_CreateArray();
+    cJSON *hashrate = cJSON_CreateArray();
+    cJSON_AddItemToObject(asic, nonces_name, nonces);
+    cJSON_AddItemToObject(asic, hashrate_name, hashrate);
+
+    for (int i = 0; i < count; i++) {
+        cJSON_AddItemToArray(nonces, cJSON_CreateNumber(counters[i].nonces));
+        cJSON_AddItemToArray(hashrate, cJSON_CreateFloat(elapsed_s > 0 ? counters[i].hashes / elapsed_s / 1e9 : 0));
+    }
+}
+
+cJSON* system_api_get_core_stats_json(GlobalState *g) {
+    if (!g) return NULL;
+    cJSON *root = cJSON_CreateObject();
+    if (root == NULL) return NULL;
+
+    CoreStatsModule *module = &g->CORE_STATS_MODULE;
+    double elapsed_s = (esp_timer_get_time() - module->start_time_us) / 1e6;
+
+    cJSON_AddNumberToObject(root, "coreCount", module->core_count);
+    cJSON_AddNumberToObject(root, "smallCoreCount", CORE_STATS_MAX_SMALL_CORES);
+    cJSON_AddNumberToObject(root, "duration", (int)elapsed_s);
+
+    cJSON *asics = cJSON_CreateArray();
+    cJSON_AddItemToObject(root, "asics", asics);
+    if (module->cores == NULL) return root;
+
+    for (int i = 0; i < module->asic_count; i++) {
+        cJSON *asic = cJSON_CreateObject();
+        cJSON_AddItemToArray(asics, asic);
+
+        const core_counter *cores = &module->cores[i * CORE_STATS_MAX_CORES];
+        uint32_t total = 0;
+        for (int c = 0; c < module->core_count; c++) {
+            total += cores[c].nonces;
+        }
+        cJSON_AddNumberToObject(asic, "nonces", total);
+
+        add_core_counters(asic, "cores", "coreHashrate", cores, module->core_count, elapsed_s);
+        add_core_counters(asic, "smallCores", "smallCoreHashrate",
+                          &module->small_cores[i * CORE_STATS_MAX_SMALL_CORES], CORE_STATS_MAX_SMALL_CORES, elapsed_s);
+
+        cJSON *idle = cJSON_CreateArray();
+        cJSON_AddItemToObject(asic, "idleCores", idle);
+        double mean = module->core_count > 0 ? (double)total / module->core_count : 0;
+        if (mean >= CORE_IDLE_MIN_MEAN_NONCES) {
+            for (int c = 0; c < module->core_count; c++) {
+                if (cores[c].nonces < mean * CORE_IDLE_FRACTION) {
+                    cJSON_AddItemToArray(idle, cJSON_CreateNumber(c));
+                }
+            }
+        }
+    }
 
     return root;
 }
@@ -14,6 +14,22 @@
  */
 cJSON* system_api_get_full_json(GlobalState *g);
 
+/**
+ * @brief Generates the per-ASIC, per-core nonce counters (/api/system/asic/cores).
+ *
+ * @param g Pointer to the GlobalState structure.
+ * @return cJSON* The root JSON object. Caller is responsible for cJSON_Delete().
+ */
+cJSON* system_api_get_core_stats_json(GlobalState *g);
+
+/**
+ * @brief Generates the submit-to-ack latency percentiles of each pool connected since boot.
+ *
+ * @param g Pointer to the GlobalState structure.
+ * @return cJSON* A JSON array. Caller is responsible for cJSON_Delete().
+ */
+cJSON* system_api_get_submit_latency_json(GlobalState *g);
+
 /**
  * @brief Custom helper to create a JSON number from a float with fixed decimal precision.
  */
@@ -12,6 +12,8 @@
 #include "cjson_utils.h"
 
 #define WEBSOCKET_API_RATE_LIMIT_MS 500
+// Core counters move slowly and are large, so they go out far less often than updates
+#define WEBSOCKET_CORE_STATS_INTERVAL_MS 10000
 
 static const char *TAG = "websocket_api";
 static GlobalState *GLOBAL_STATE = NULL;
@@ -76,6 +78,41 @@ static cJSON* process_and_send_update(cJSON *last_state, int fd)
     return current_full;
 }
 
+/**
+ * @brief Sends the per-core nonce counters as an "asicCores" event.
+ *
+ * @param fd Client file descriptor (-1 for broadcast).
+ */
+static void send_core_stats(int fd)
+{
+    cJSON *msg = cJSON_CreateObject();
+    cJSON *data = system_api_get_core_stats_json(GLOBAL_STATE);
+    if (!msg || !data) {
+        cJSON_Delete(msg);
+        cJSON_Delete(data);
+        return;
+    }
+    cJSON_AddStringToObject(msg, "event", "asicCores");
+    cJSON_AddItemToObject(msg, "data", data);
+
+    char *json_str = cJSON_PrintUnformatted(msg);
+    if (json_str != NULL) {
+        httpd_ws_frame_t ws_pkt;
+        memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
+        ws_pkt.payload = (uint8_t *)json_str;
+        ws_pkt.len = strlen(json_str);
+        ws_pkt.type = HTTPD_WS_TYPE_TEXT;
+
+        if (fd == -1) {
+            websocket_broadcast(WS_TYPE_API, &ws_pkt);
+        } else {
+            websocket_send_to_client(fd, &ws_pkt);
+        }
+        free(json_str);
+    }
+    cJSON_Delete(msg);
+}
+
 void websocket_api_on_connect(int fd)
 {
     if (GLOBAL_STATE == NULL) {
@@ -86,6 +123,7 @@ void websocket_api_on_connect(int fd)
     // On connect, we diff against NULL to send the full current state
     cJSON *full = process_and_send_update(NULL, fd);
     cJSON_Delete(full);
+    send_core_stats(fd);
 }
 
 void websocket_api_task(void *pvParameters)
@@ -100,6 +138,7 @@ void websocket_api_task(void *pvParameters)
 
     // Initialize the baseline state
     cJSON *last_full_json = system_api_get_full_json(GLOBAL_STATE);
+    int core_stats_elapsed_ms = 0;
 
     while (true) {
         vTaskDelay(pdMS_TO_TICKS(WEBSOCKET_API_RATE_LIMIT_MS));
@@ -125,5 +164,11 @@ void websocket_api_task(void *pvParameters)
             cJSON_Delete(last_full_json);
             last_full_json = new_full_json;
         }
+
+        core_stats_elapsed_ms += WEBSOCKET_API_RATE_LIMIT_MS;
+        if (core_stats_elapsed_ms >= WEBSOCKET_CORE_STATS_INTERVAL_MS) {
+            core_stats_elapsed_ms = 0;
+            send_core_stats(-1);
+        }
     }
 }
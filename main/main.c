@@ -7,10 +7,13 @@
 #include "cJSON.h"
 
 #include "asic_result_task.h"
+#include "share_submit_task.h"
+#include "core_stats.h"
 #include "create_jobs_task.h"
 #include "hashrate_monitor_task.h"
 #include "fan_controller_task.h"
 #include "statistics_task.h"
+#include "difficulty_tuner_task.h"
 #include "system.h"
 #include "http_server.h"
 #include "serial.h"
@@ -118,6 +121,10 @@ void app_main(void)
         return;
     }
 
+    if (core_stats_init(&GLOBAL_STATE) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init core statistics");
+    }
+
     if (self_test_init(&GLOBAL_STATE) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to init self test");
         return;
@@ -177,9 +184,19 @@ void app_main(void)
             self_test_show_message(&GLOBAL_STATE, GLOBAL_STATE.SYSTEM_MODULE.asic_status);
             system_init_ret = ESP_FAIL;
         } else {
-            if (xTaskCreate(create_jobs_task, "stratum miner", 8192, (void *) &GLOBAL_STATE, 20, NULL) != pdPASS) {
+#ifdef CONFIG_STRATUM_PARALLEL_MIDSTATES
+            // Pinned so work_split_init() can pin its helper to the other core (core 0, next to WiFi)
+            BaseType_t jobs_task_created = xTaskCreatePinnedToCore(create_jobs_task, "stratum miner", 8192, (void *) &GLOBAL_STATE, 20, NULL, 1);
+#else
+            BaseType_t jobs_task_created = xTaskCreate(create_jobs_task, "stratum miner", 8192, (void *) &GLOBAL_STATE, 20, NULL);
+#endif
+            if (jobs_task_created != pdPASS) {
                 ESP_LOGE(TAG, "Error creating stratum miner task");
             }
+            if (!share_submit_init(&GLOBAL_STATE) ||
+                xTaskCreate(share_submit_task, "share submit", 8192, (void *) &GLOBAL_STATE, 12, NULL) != pdPASS) {
+                ESP_LOGE(TAG, "Error creating share submit task");
+            }
             if (xTaskCreate(ASIC_result_task, "asic result", 8192, (void *) &GLOBAL_STATE, 15, NULL) != pdPASS) {
                 ESP_LOGE(TAG, "Error creating asic result task");
             }
@@ -190,6 +207,9 @@ void app_main(void)
             if (xTaskCreateWithCaps(statistics_task, "statistics", 8192, (void *) &GLOBAL_STATE, 3, NULL, MALLOC_CAP_SPIRAM) != pdPASS) {
                 ESP_LOGE(TAG, "Error creating statistics task");
             }
+            if (xTaskCreateWithCaps(difficulty_tuner_task, "difficulty tuner", 4096, (void *) &GLOBAL_STATE, 3, NULL, MALLOC_CAP_SPIRAM) != pdPASS) {
+                ESP_LOGE(TAG, "Error creating difficulty tuner task");
+            }
         }
     }
 
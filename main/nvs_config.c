@@ -42,6 +42,8 @@ typedef struct {
     ConfigType type;
     ConfigValue value;
     int index;
+    const char *blob_key; // Set by nvs_config_set_blob(), value.str then holds blob_len bytes
+    size_t blob_len;
 } ConfigUpdate;
 
 static const char * TAG = "nvs_config";
@@ -77,13 +79,14 @@ static Settings settings[NVS_CONFIG_COUNT] = {
     [NVS_CONFIG_OVERHEAT_MODE]                         = {.nvs_key_name = "overheat_mode",   .type = TYPE_BOOL,                                                                         .rest_name = "overheat_mode",                      .min = 0,  .max = 0},
 
     [NVS_CONFIG_STATISTICS_FREQUENCY]                  = {.nvs_key_name = "statsFrequency",  .type = TYPE_U16,                                                                          .rest_name = "statsFrequency",                     .min = 0,  .max = UINT16_MAX},
+    [NVS_CONFIG_TARGET_SHARE_RATE]                     = {.nvs_key_name = "sharerate",       .type = TYPE_U16,                                                                          .rest_name = "targetSharesPerMinute",              .min = 0,  .max = 600},
 
     [NVS_CONFIG_BEST_DIFF]                             = {.nvs_key_name = "bestdiff",        .type = TYPE_U64},
     [NVS_CONFIG_SELF_TEST]                             = {.nvs_key_name = "selftest",        .type = TYPE_BOOL},
     [NVS_CONFIG_SWARM]                                 = {.nvs_key_name = "swarmconfig",     .type = TYPE_STR},
     [NVS_CONFIG_THEME_SCHEME]                          = {.nvs_key_name = "themescheme",     .type = TYPE_STR,   .default_value = {.str = DEFAULT_THEME}},
     [NVS_CONFIG_THEME_COLOR]                           = {.nvs_key_name = "themecolor",      .type = TYPE_STR,   .default_value = {.str = DEFAULT_COLOR}},
-    [NVS_CONFIG_SCOREBOARD]                            = {.nvs_key_name = "scoreboard",      .type = TYPE_STR,   .array_size = MAX_SCOREBOARD},
+    [NVS_CONFIG_SCOREBOARD]                            = {.nvs_key_name = "scoreboard",      .type = TYPE_STR,   .array_size = MAX_SCOREBOARD}, // Legacy, read once to migrate to the scoreboard blob
     
     [NVS_CONFIG_BOARD_VERSION]                         = {.nvs_key_name = "boardversion",    .type = TYPE_STR,   .default_value = {.str = "000"}},
     [NVS_CONFIG_DEVICE_MODEL]                          = {.nvs_key_name = "devicemodel",     .type = TYPE_STR,   .default_value = {.str = "unknown"}},
@@ -318,6 +321,18 @@ static void nvs_task(void *pvParameters)
     while (1) {
         ConfigUpdate update;
         if (xQueueReceive(nvs_save_queue, &update, portMAX_DELAY) == pdTRUE) {
+            if (update.blob_key) {
+                esp_err_t ret = nvs_set_blob(handle, update.blob_key, update.value.str, update.blob_len);
+                if (ret == ESP_OK) {
+                    ret = nvs_commit(handle);
+                }
+                if (ret != ESP_OK) {
+                    ESP_LOGE(TAG, "Failed to write blob %s to NVS: %s", update.blob_key, esp_err_to_name(ret));
+                }
+                free(update.value.str);
+                continue;
+            }
+
             Settings *setting = nvs_config_get_settings(update.key);
             if (setting && setting->type == update.type) {
                 esp_err_t ret = ESP_OK;
@@ -577,6 +592,23 @@ void nvs_config_set_string_indexed(NvsConfigKey key, int index, const char *valu
     xQueueSend(nvs_save_queue, &update, portMAX_DELAY);
 }
 
+esp_err_t nvs_config_get_blob(const char *nvs_key, void *data, size_t *len)
+{
+    return nvs_get_blob(handle, nvs_key, data, len);
+}
+
+esp_err_t nvs_config_set_blob(const char *nvs_key, const void *data, size_t len)
+{
+    ConfigUpdate update = { .blob_key = nvs_key, .blob_len = len, .value.str = malloc(len) };
+    if (!update.value.str) return ESP_ERR_NO_MEM;
+    memcpy(update.value.str, data, len);
+    if (xQueueSend(nvs_save_queue, &update, 0) != pdTRUE) {
+        free(update.value.str);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
 uint16_t nvs_config_get_u16(NvsConfigKey key)
 {
     Settings *setting = nvs_config_get_settings(key);
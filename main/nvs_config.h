@@ -32,6 +32,7 @@ typedef enum {
     NVS_CONFIG_OVERHEAT_MODE,
     
     NVS_CONFIG_STATISTICS_FREQUENCY,
+    NVS_CONFIG_TARGET_SHARE_RATE,
     
     NVS_CONFIG_BEST_DIFF,
     NVS_CONFIG_SELF_TEST,
@@ -100,6 +101,10 @@ char *nvs_config_get_string(NvsConfigKey key);
 char *nvs_config_get_string_indexed(NvsConfigKey key, int index);
 void nvs_config_set_string(NvsConfigKey key, const char * value);
 void nvs_config_set_string_indexed(NvsConfigKey key, int index, const char *value);
+// Raw blobs outside the settings table. Writes are copied and queued to the
+// NVS task without blocking; nvs_key must outlive the write (a literal).
+esp_err_t nvs_config_get_blob(const char *nvs_key, void *data, size_t *len);
+esp_err_t nvs_config_set_blob(const char *nvs_key, const void *data, size_t len);
 uint16_t nvs_config_get_u16(NvsConfigKey key);
 void nvs_config_set_u16(NvsConfigKey key, uint16_t value);
 int32_t nvs_config_get_i32(NvsConfigKey key);
@@ -56,7 +56,7 @@ uint8_t asic_initialize(GlobalState *GLOBAL_STATE, asic_init_mode_t mode, uint32
 
     ESP_LOGI(TAG, "Setting max baud rate and clearing buffers");
     SERIAL_set_baud(ASIC_set_max_baud(GLOBAL_STATE));
-    SERIAL_clear_buffer();
+    clear_asic_rx();
 
     GLOBAL_STATE->ASIC_initalized = true;
     
@@ -57,6 +57,7 @@ static void parse_pool_config_json(const char *json_str, PoolConfig *cfg, int in
     cfg->tls = index == 0 ? CONFIG_STRATUM_TLS : 0;
     cfg->cert = strdup("");
     cfg->decode_coinbase_tx = true;
+    cfg->ntime_roll = false;
     cfg->sv2_channel_type = SV2_CHANNEL_EXTENDED;
     cfg->sv2_authority_pubkey = strdup("");
 
@@ -126,6 +127,11 @@ static void parse_pool_config_json(const char *json_str, PoolConfig *cfg, int in
         cfg->decode_coinbase_tx = cJSON_IsTrue(item) || (cJSON_IsNumber(item) && item->valueint != 0);
     }
 
+    item = cJSON_GetObjectItem(root, "stratumNtimeRoll");
+    if (item && (cJSON_IsBool(item) || cJSON_IsNumber(item))) {
+        cfg->ntime_roll = cJSON_IsTrue(item) || (cJSON_IsNumber(item) && item->valueint != 0);
+    }
+
     item = cJSON_GetObjectItem(root, "stratumV2ChannelType");
     if (item && cJSON_IsString(item)) {
         sv2_channel_type_t t = sv2_channel_type_from_string(item->valuestring);
@@ -209,8 +215,6 @@ void SYSTEM_init_system(GlobalState * GLOBAL_STATE)
     GLOBAL_STATE->stratum_protocol = module->pools[active_pool_idx].protocol;
     GLOBAL_STATE->sv2_conn = NULL;
 
-    // Initialize mutexes
-    pthread_mutex_init(&GLOBAL_STATE->valid_jobs_lock, NULL);
     GLOBAL_STATE->stratum_mux = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
 }
 
@@ -343,11 +347,7 @@ void SYSTEM_clean_jobs_queue(GlobalState * GLOBAL_STATE)
     ESP_LOGI(TAG, "Clean Jobs: clearing queue");
     queue_clear(&GLOBAL_STATE->stratum_queue);
 
-    pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-    for (int i = 0; i < 128; i = i + 4) {
-        GLOBAL_STATE->valid_jobs[i] = 0;
-    }
-    pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
+    job_table_invalidate_all(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs);
 
     // Reset hashrate measurements to prevent a spike on reconnection
     hashrate_monitor_reset_measurements(GLOBAL_STATE);
@@ -410,6 +410,31 @@ void SYSTEM_notify_new_ntime(GlobalState * GLOBAL_STATE, uint32_t ntime)
     settimeofday(&tv, NULL);
 }
 
+static uint16_t active_pool_index(GlobalState * GLOBAL_STATE)
+{
+    SystemModule * module = &GLOBAL_STATE->SYSTEM_MODULE;
+    return module->is_using_fallback ? module->secondary_pool_index : module->primary_pool_index;
+}
+
+void SYSTEM_notify_pool_connected(GlobalState * GLOBAL_STATE, stratum_protocol_t protocol)
+{
+    PoolLatency * latency = &GLOBAL_STATE->SYSTEM_MODULE.submit_latency[active_pool_index(GLOBAL_STATE)];
+
+    latency_histogram_reset(&latency->histogram);
+    latency->protocol = protocol;
+
+    // Shares still queued from the previous connection carry its job ids
+    GLOBAL_STATE->SHARE_SUBMIT_MODULE.connection_generation++;
+}
+
+void SYSTEM_notify_share_response(GlobalState * GLOBAL_STATE, float response_time_ms)
+{
+    SystemModule * module = &GLOBAL_STATE->SYSTEM_MODULE;
+
+    module->response_time = response_time_ms;
+    latency_histogram_record(&module->submit_latency[active_pool_index(GLOBAL_STATE)].histogram, (uint32_t)(response_time_ms * 1000.0f));
+}
+
 void SYSTEM_notify_found_nonce(GlobalState * GLOBAL_STATE, double diff, uint32_t target)
 {
     SystemModule * module = &GLOBAL_STATE->SYSTEM_MODULE;
@@ -18,6 +18,10 @@ void SYSTEM_notify_accepted_share(GlobalState * GLOBAL_STATE);
 void SYSTEM_notify_rejected_share(GlobalState * GLOBAL_STATE, char * error_msg);
 void SYSTEM_notify_found_nonce(GlobalState * GLOBAL_STATE, double diff, uint32_t target);
 void SYSTEM_notify_new_ntime(GlobalState * GLOBAL_STATE, uint32_t ntime);
+// A new connection to the active pool: start its submit latency histogram over
+void SYSTEM_notify_pool_connected(GlobalState * GLOBAL_STATE, stratum_protocol_t protocol);
+// The pool acknowledged a share response_time_ms after it was written
+void SYSTEM_notify_share_response(GlobalState * GLOBAL_STATE, float response_time_ms);
 
 stratum_protocol_t stratum_protocol_from_string(const char *s);
 sv2_channel_type_t sv2_channel_type_from_string(const char *s);
@@ -8,19 +8,50 @@
 #include "esp_log.h"
 #include "nvs_config.h"
 #include "utils.h"
-#include "stratum_v2_task.h"
-#include "sv2_protocol.h"
 #include "hashrate_monitor_task.h"
 #include "asic.h"
 #include "freertos/task.h"
 #include "scoreboard.h"
 #include "self_test.h"
+#include "share_submit_task.h"
+#include "core_stats.h"
+#include "esp_timer.h"
 
 static const char *TAG = "asic_result";
 
+#define RX_RATE_INTERVAL_US 1000000
+#define LATENCY_EMA_ALPHA 0.1f
+
+static void update_rx_rate(AsicTaskModule *module, int64_t *window_start_us, uint32_t *window_wakeups)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - *window_start_us;
+    if (elapsed < RX_RATE_INTERVAL_US) return;
+
+    uint32_t wakeups = SERIAL_rx_wakeups();
+    module->rx_wakeups_per_s = (wakeups - *window_wakeups) * 1000000.0f / elapsed;
+    *window_wakeups = wakeups;
+    *window_start_us = now;
+}
+
+static void record_intake_latency(AsicTaskModule *module, uint64_t read_us)
+{
+    uint32_t latency_us = esp_timer_get_time() - read_us;
+    module->nonces_validated++;
+    module->nonce_intake_latency_us = module->nonces_validated == 1 ? latency_us
+        : module->nonce_intake_latency_us + LATENCY_EMA_ALPHA * (latency_us - module->nonce_intake_latency_us);
+    if (latency_us > module->nonce_intake_latency_max_us) {
+        module->nonce_intake_latency_max_us = latency_us;
+    }
+}
+
 void ASIC_result_task(void *pvParameters)
 {
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    AsicTaskModule *asic_task = &GLOBAL_STATE->ASIC_TASK_MODULE;
+
+    int64_t rx_window_start_us = esp_timer_get_time();
+    uint32_t rx_window_wakeups = 0;
 
     while (1)
     {
@@ -31,6 +62,7 @@ void ASIC_result_task(void *pvParameters)
         }
 
         task_result *asic_result = ASIC_process_work(GLOBAL_STATE);
+        update_rx_rate(asic_task, &rx_window_start_us, &rx_window_wakeups);
 
         if (asic_result == NULL)
         {
@@ -42,104 +74,77 @@ void ASIC_result_task(void *pvParameters)
             continue;
         }
 
+        core_stats_record(GLOBAL_STATE, asic_result->asic_nr, asic_result->core_id, asic_result->small_core_id);
+
         uint8_t job_id = asic_result->job_id;
 
-        // Snapshot the job while holding the lock. The shared slot
-        // (ASIC_TASK_MODULE.active_jobs[job_id]) can be freed and reused by
-        // BM1370_send_work() while we run the (potentially multi-second, blocking)
-        // share submit below; keeping a pointer into it is a use-after-free. The
-        // bm_job body is inline and safe to copy by value — deep-copy the two
-        // heap-owned strings so the snapshot stays valid after we unlock.
-        pthread_mutex_lock(&GLOBAL_STATE->valid_jobs_lock);
-        bool valid = (GLOBAL_STATE->valid_jobs[job_id] != 0) &&
-                     (GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id] != NULL);
-        if (!valid)
+        // Copy the job out of its slot without locking. The copy only succeeds
+        // if send_work has not reused the slot since the driver read the
+        // version; otherwise the job this nonce belongs to is already gone.
+        bm_job active_job_snapshot;
+        if (!job_table_read(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job_id, asic_result->job_generation, &active_job_snapshot))
         {
-            pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
             ESP_LOGW(TAG, "Invalid job nonce found, 0x%02X", job_id);
             continue;
         }
-        bm_job active_job_snapshot = *GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[job_id];
-        active_job_snapshot.jobid = active_job_snapshot.jobid ? strdup(active_job_snapshot.jobid) : NULL;
-        active_job_snapshot.extranonce2 = active_job_snapshot.extranonce2 ? strdup(active_job_snapshot.extranonce2) : NULL;
-        pthread_mutex_unlock(&GLOBAL_STATE->valid_jobs_lock);
         bm_job *active_job = &active_job_snapshot;
-        // check the nonce difficulty
-        double nonce_diff = test_nonce_value(active_job, asic_result->nonce, asic_result->rolled_version);
 
         if (GLOBAL_STATE->SELF_TEST_MODULE.is_active) {
-            self_test_record_nonce(GLOBAL_STATE, nonce_diff);
-            free(active_job->jobid);
-            free(active_job->extranonce2);
+            self_test_record_nonce(GLOBAL_STATE, test_nonce_value(active_job, asic_result->nonce, asic_result->rolled_version));
+            continue;
+        }
+
+        // A nonce below the pool difficulty, the session best and the scoreboard
+        // cannot change anything below, so its exact difficulty is not needed
+        double min_diff = active_job->pool_diff;
+        if (GLOBAL_STATE->SYSTEM_MODULE.best_session_nonce_diff < min_diff) {
+            min_diff = GLOBAL_STATE->SYSTEM_MODULE.best_session_nonce_diff;
+        }
+        double scoreboard_min = scoreboard_min_difficulty(&GLOBAL_STATE->SYSTEM_MODULE.scoreboard);
+        if (scoreboard_min < min_diff) {
+            min_diff = scoreboard_min;
+        }
+
+        double nonce_diff = test_nonce_value_min(active_job, asic_result->nonce, asic_result->rolled_version, min_diff);
+        record_intake_latency(asic_task, asic_result->timestamp_us);
+        if (nonce_diff == 0.0) {
+            ESP_LOGI(TAG, "ID: %s, ASIC nr: %d, Core: %d/%d, ver: %08" PRIX32 " Nonce %08" PRIX32 " diff below %g.", active_job->jobid, asic_result->asic_nr, asic_result->core_id, asic_result->small_core_id, asic_result->rolled_version, asic_result->nonce, min_diff);
             continue;
         }
 
         uint32_t version_bits = asic_result->rolled_version ^ active_job->version;
-        if (nonce_diff >= active_job->pool_diff)
+
+        // Checked before anything else so a block solution jumps the submit queue
+        bool is_block = nonce_diff >= networkDifficulty(active_job->target);
+
+        if (nonce_diff >= active_job->pool_diff || is_block)
         {
-            if (GLOBAL_STATE->stratum_protocol == STRATUM_PROTOCOL_V2) {
-                // SV2: submit with binary protocol
-                int ret;
-                uint32_t sv2_job_id = (uint32_t)strtoul(active_job->jobid, NULL, 10);
-
-                if (stratum_v2_is_extended_channel(GLOBAL_STATE)) {
-                    sv2_conn_t *conn = GLOBAL_STATE->sv2_conn;
-                    // SV2 spec: extranonce_size is the miner's rollable portion.
-                    // The pool prepends its extranonce_prefix separately.
-                    uint8_t en2_len = conn->extranonce_size;
-                    uint8_t extranonce_2[32];
-                    hex2bin(active_job->extranonce2, extranonce_2, en2_len);
-                    ret = stratum_v2_submit_share_extended(GLOBAL_STATE, sv2_job_id,
-                                                           asic_result->nonce,
-                                                           active_job->ntime,
-                                                           asic_result->rolled_version,
-                                                           extranonce_2, en2_len);
-                } else {
-                    ret = stratum_v2_submit_share(GLOBAL_STATE, sv2_job_id,
-                                                   asic_result->nonce,
-                                                   active_job->ntime,
-                                                   asic_result->rolled_version);
-                }
-
-                if (ret < 0) {
-                    ESP_LOGW(TAG, "Failed to submit SV2 share (ret=%d, errno=%d: %s)",
-                             ret, errno, strerror(errno));
-                }
-            } else {
-                // V1: submit with JSON-RPC
-                uint16_t active_idx = GLOBAL_STATE->SYSTEM_MODULE.is_using_fallback ? GLOBAL_STATE->SYSTEM_MODULE.secondary_pool_index : GLOBAL_STATE->SYSTEM_MODULE.primary_pool_index;
-                char * user = GLOBAL_STATE->SYSTEM_MODULE.pools[active_idx].user;
-
-                taskENTER_CRITICAL(&GLOBAL_STATE->stratum_mux);
-                esp_transport_handle_t transport = GLOBAL_STATE->transport;
-                int uid = GLOBAL_STATE->send_uid++;
-                taskEXIT_CRITICAL(&GLOBAL_STATE->stratum_mux);
-
-                if (transport == NULL) {
-                    ESP_LOGW(TAG, "No stratum connection, dropping share (job 0x%02X)", job_id);
-                } else {
-                    uint64_t sent_time_us = 0;
-                    int ret = STRATUM_V1_submit_share(
-                        transport,
-                        uid,
-                        user,
-                        active_job->jobid,
-                        active_job->extranonce2,
-                        active_job->ntime,
-                        asic_result->nonce,
-                        version_bits,
-                        &sent_time_us);
-
-                    if (ret < 0) {
-                        ESP_LOGW(TAG, "Unable to write share to socket (ret: %d, errno %d: %s)", ret, errno, strerror(errno));
-                        // stratum_task recv loop will detect a broken connection on its next read and handle reconnection
-                    }
-
-                    float process_time = (sent_time_us - asic_result->timestamp_us) / 1000.0f;
-                    GLOBAL_STATE->SYSTEM_MODULE.process_time = process_time;
-                    ESP_LOGI(TAG, "Processing time: %0.1f ms", process_time);
-                }
+            // The pool would reject a share it has already seen
+            ShareSubmitModule *share_submit = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+            uint64_t share_key = share_filter_key(active_job->jobid, active_job->extranonce2, active_job->ntime, asic_result->nonce, version_bits);
+            if (share_filter_check_and_add(&share_submit->recent_shares, share_key)) {
+                share_submit->duplicates++;
+                ESP_LOGW(TAG, "ID: %s, Nonce %08" PRIX32 " ver: %08" PRIX32 " already submitted, skipping duplicate.", active_job->jobid, asic_result->nonce, asic_result->rolled_version);
+                continue;
             }
+
+            // Hand the share to share_submit_task; network I/O never blocks nonce intake
+            share_record share = {
+                .protocol = GLOBAL_STATE->stratum_protocol,
+                .connection = share_submit->connection_generation,
+                .ntime = active_job->ntime,
+                .nonce = asic_result->nonce,
+                .version = asic_result->rolled_version,
+                .version_bits = version_bits,
+                .block = is_block,
+                .found_time_us = asic_result->timestamp_us,
+                .enqueued_time_us = esp_timer_get_time(),
+            };
+            strcpy(share.jobid, active_job->jobid);
+            size_t extranonce2_len = strlen(active_job->extranonce2) / 2;
+            share.extranonce2_len = hex2bin(active_job->extranonce2, share.extranonce2,
+                                            extranonce2_len < sizeof(share.extranonce2) ? extranonce2_len : sizeof(share.extranonce2));
+            share_submit_enqueue(GLOBAL_STATE, &share);
         }
 
         //log the ASIC response
@@ -148,8 +153,5 @@ void ASIC_result_task(void *pvParameters)
         SYSTEM_notify_found_nonce(GLOBAL_STATE, nonce_diff, active_job->target);
 
         scoreboard_add(&GLOBAL_STATE->SYSTEM_MODULE.scoreboard, nonce_diff, active_job->jobid, active_job->extranonce2, active_job->ntime, asic_result->nonce, version_bits);
-
-        free(active_job->jobid);
-        free(active_job->extranonce2);
     }
 }
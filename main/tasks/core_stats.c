@@ -0,0 +1,53 @@
+#include "core_stats.h"
+#include "global_state.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "core_stats";
+
+static const double HASHES_PER_DIFF_1 = 4294967296.0; // 2^32
+
+esp_err_t core_stats_init(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    CoreStatsModule *module = &GLOBAL_STATE->CORE_STATS_MODULE;
+
+    uint8_t asic_count = GLOBAL_STATE->DEVICE_CONFIG.family.asic_count;
+    module->cores = heap_caps_calloc(asic_count * CORE_STATS_MAX_CORES, sizeof(core_counter), MALLOC_CAP_SPIRAM);
+    module->small_cores = heap_caps_calloc(asic_count * CORE_STATS_MAX_SMALL_CORES, sizeof(core_counter), MALLOC_CAP_SPIRAM);
+    if (module->cores == NULL || module->small_cores == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate core statistics");
+        heap_caps_free(module->cores);
+        heap_caps_free(module->small_cores);
+        module->cores = NULL;
+        module->small_cores = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint16_t core_count = GLOBAL_STATE->DEVICE_CONFIG.family.asic.core_count;
+    module->core_count = core_count < CORE_STATS_MAX_CORES ? core_count : CORE_STATS_MAX_CORES;
+    module->start_time_us = esp_timer_get_time();
+    module->asic_count = asic_count;
+    return ESP_OK;
+}
+
+void core_stats_record(void *pvParameters, uint8_t asic_nr, uint8_t core_id, uint8_t small_core_id)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    CoreStatsModule *module = &GLOBAL_STATE->CORE_STATS_MODULE;
+
+    if (asic_nr >= module->asic_count) {
+        return;
+    }
+
+    double hashes = GLOBAL_STATE->DEVICE_CONFIG.family.asic.difficulty * HASHES_PER_DIFF_1;
+
+    core_counter *core = &module->cores[asic_nr * CORE_STATS_MAX_CORES + (core_id % CORE_STATS_MAX_CORES)];
+    core->nonces++;
+    core->hashes += hashes;
+
+    core_counter *small_core = &module->small_cores[asic_nr * CORE_STATS_MAX_SMALL_CORES + (small_core_id % CORE_STATS_MAX_SMALL_CORES)];
+    small_core->nonces++;
+    small_core->hashes += hashes;
+}
@@ -0,0 +1,31 @@
+#ifndef CORE_STATS_H_
+#define CORE_STATS_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// core_id is 7 bits and small_core_id 4 bits wide in every chip's nonce response
+#define CORE_STATS_MAX_CORES 128
+#define CORE_STATS_MAX_SMALL_CORES 16
+
+typedef struct {
+    uint32_t nonces;
+    double hashes; // nonces weighted by the ticket difficulty they were found at
+} core_counter;
+
+// Nonces returned per ASIC x core and per ASIC x small core since boot. A core
+// that stopped hashing stands out against the otherwise even spread.
+typedef struct {
+    core_counter *cores;       // asic_count * CORE_STATS_MAX_CORES, in PSRAM
+    core_counter *small_cores; // asic_count * CORE_STATS_MAX_SMALL_CORES, in PSRAM
+    uint8_t asic_count;
+    uint16_t core_count;       // cores reported, CORE_STATS_MAX_CORES at most
+    uint64_t start_time_us;
+} CoreStatsModule;
+
+esp_err_t core_stats_init(void *pvParameters);
+
+// Called by ASIC_result_task for every nonce
+void core_stats_record(void *pvParameters, uint8_t asic_nr, uint8_t core_id, uint8_t small_core_id);
+
+#endif /* CORE_STATS_H_ */
@@ -16,15 +16,99 @@
 #include "stratum_api.h"
 #include "stratum_v2_task.h"
 #include "utils.h"
+#include "work_split.h"
 
 static const char *TAG = "create_jobs_task";
 
-#define MAX_EXTRANONCE2_LEN 32
-#define MAX_EXTRANONCE2_STR (MAX_EXTRANONCE2_LEN * 2 + 1)
+#define MAX_EXTRANONCE1_LEN 32
+#define MAX_EXTRANONCE2_LEN ((BM_JOB_EXTRANONCE2_SIZE - 1) / 2)
 
-static void generate_work(GlobalState *GLOBAL_STATE, mining_notify *notification, uint64_t extranonce_2, double difficulty);
-static void generate_work_sv2(GlobalState *GLOBAL_STATE, sv2_job_t *job, double difficulty);
-static void generate_work_sv2_ext(GlobalState *GLOBAL_STATE, sv2_ext_job_t *job, double difficulty, uint64_t extranonce_2_counter);
+// Binary coinbase of the current V1 notify / SV2 extended job, rebuilt whenever new work is dequeued
+static coinbase_template v1_coinbase;
+static bool v1_coinbase_valid = false;
+static coinbase_template sv2_ext_coinbase;
+static bool sv2_ext_coinbase_valid = false;
+
+// Jobs for the current work are built ahead while the ASIC hashes, so a send is just a pop
+#define JOB_RING_SIZE 4
+
+typedef struct {
+    bm_job jobs[JOB_RING_SIZE];
+    int head;
+    int count;
+} job_ring;
+
+static job_ring ready_jobs;
+static bm_job inline_job;
+
+// SV1 ntime rolling: extra work from the last built job by bumping ntime, which
+// lives in the second SHA-256 block, so coinbase, merkle root and midstates are reused.
+// Rolled ntimes stay within ntime_roll_limit(): the notify ntime plus the time since it
+// arrived, so they never lead real time by more than NTIME_ROLL_ALLOWANCE_S.
+
+static bool ntime_roll_enabled = false;
+static bool ntime_roll_base_valid = false;
+static bm_job ntime_roll_base;
+static uint32_t ntime_roll_offset = 0;
+
+static bool generate_work(GlobalState *GLOBAL_STATE, mining_notify *notification, uint64_t extranonce_2, double difficulty, bm_job *next_job);
+static bool generate_work_sv2(GlobalState *GLOBAL_STATE, sv2_job_t *job, double difficulty, bm_job *next_job);
+static bool generate_work_sv2_ext(GlobalState *GLOBAL_STATE, sv2_ext_job_t *job, double difficulty, uint64_t extranonce_2_counter, bm_job *next_job);
+
+// Splice the session extranonce_1 between coinbase_1 and coinbase_2 once per notify,
+// leaving room for extranonce_2 which is patched in for every job.
+static bool prepare_coinbase_template(GlobalState *GLOBAL_STATE, mining_notify *notification)
+{
+    if (GLOBAL_STATE->extranonce_2_len > MAX_EXTRANONCE2_LEN) {
+        ESP_LOGE(TAG, "extranonce_2_len %d exceeds maximum %d", GLOBAL_STATE->extranonce_2_len, MAX_EXTRANONCE2_LEN);
+        return false;
+    }
+    if (strlen(notification->job_id) >= BM_JOB_ID_SIZE) {
+        ESP_LOGE(TAG, "Job id %s exceeds maximum length %d", notification->job_id, BM_JOB_ID_SIZE - 1);
+        return false;
+    }
+
+    const char *extranonce_str = GLOBAL_STATE->extranonce_str ? GLOBAL_STATE->extranonce_str : "";
+    uint8_t extranonce_bin[MAX_EXTRANONCE1_LEN];
+    size_t extranonce_len = strlen(extranonce_str) / 2;
+    if (extranonce_len > MAX_EXTRANONCE1_LEN) {
+        ESP_LOGE(TAG, "extranonce_1 length %d exceeds maximum %d", (int)extranonce_len, MAX_EXTRANONCE1_LEN);
+        return false;
+    }
+    hex2bin(extranonce_str, extranonce_bin, extranonce_len);
+
+    if (!coinbase_template_init(&v1_coinbase,
+                                notification->coinbase_1_bin, notification->coinbase_1_len,
+                                extranonce_bin, extranonce_len,
+                                GLOBAL_STATE->extranonce_2_len,
+                                notification->coinbase_2_bin, notification->coinbase_2_len)) {
+        ESP_LOGE(TAG, "Failed to allocate coinbase template");
+        return false;
+    }
+    return true;
+}
+
+// SV2 extended channel: extranonce_prefix is fixed by the pool for the whole channel
+static bool prepare_sv2_ext_coinbase_template(GlobalState *GLOBAL_STATE, sv2_ext_job_t *ext_job)
+{
+    sv2_conn_t *conn = GLOBAL_STATE->sv2_conn;
+    if (!conn) return false;
+
+    if (conn->extranonce_size > MAX_EXTRANONCE2_LEN) {
+        ESP_LOGE(TAG, "SV2 extranonce_size %d exceeds maximum %d", conn->extranonce_size, MAX_EXTRANONCE2_LEN);
+        return false;
+    }
+
+    if (!coinbase_template_init(&sv2_ext_coinbase,
+                                ext_job->coinbase_prefix, ext_job->coinbase_prefix_len,
+                                conn->extranonce_prefix, conn->extranonce_prefix_len,
+                                conn->extranonce_size,
+                                ext_job->coinbase_suffix, ext_job->coinbase_suffix_len)) {
+        ESP_LOGE(TAG, "Failed to allocate SV2 coinbase template");
+        return false;
+    }
+    return true;
+}
 
 // Free a work item using the correct free function for the protocol it was created under
 static void free_work_item(GlobalState *GLOBAL_STATE, void *work, stratum_protocol_t protocol)
@@ -41,17 +125,96 @@ static void free_work_item(GlobalState *GLOBAL_STATE, void *work, stratum_protoc
     }
 }
 
+// Drop prebuilt jobs; they belong to work that is no longer current
+static void job_ring_flush(job_ring *ring)
+{
+    ring->head = 0;
+    ring->count = 0;
+}
+
+// The returned slot stays valid until the next fill
+static bm_job *job_ring_pop(job_ring *ring)
+{
+    if (ring->count == 0) return NULL;
+    bm_job *job = &ring->jobs[ring->head];
+    ring->head = (ring->head + 1) % JOB_RING_SIZE;
+    ring->count--;
+    return job;
+}
+
+// Build the next job for the current work, advancing extranonce_2 where the protocol rolls it
+static bool build_next_job(GlobalState *GLOBAL_STATE, void *work, stratum_protocol_t protocol,
+                           double difficulty, uint64_t *extranonce_2, bm_job *next_job)
+{
+    bool built;
+    if (protocol == STRATUM_PROTOCOL_V2) {
+        if (stratum_v2_is_extended_channel(GLOBAL_STATE)) {
+            built = generate_work_sv2_ext(GLOBAL_STATE, (sv2_ext_job_t *)work, difficulty, (*extranonce_2)++, next_job);
+        } else {
+            built = generate_work_sv2(GLOBAL_STATE, (sv2_job_t *)work, difficulty, next_job);
+        }
+    } else {
+        mining_notify *notification = (mining_notify *)work;
+        if (ntime_roll_enabled && ntime_roll_base_valid &&
+            ntime_roll_base.ntime + ntime_roll_offset < ntime_roll_limit(notification->ntime, notification->received_time_us, esp_timer_get_time())) {
+            *next_job = ntime_roll_base;
+            next_job->ntime += ++ntime_roll_offset;
+            GLOBAL_STATE->SYSTEM_MODULE.jobs_ntime_rolled++;
+            return true;
+        }
+        built = generate_work(GLOBAL_STATE, notification, (*extranonce_2)++, difficulty, next_job);
+        if (built && ntime_roll_enabled) {
+            ntime_roll_base = *next_job;
+            ntime_roll_base_valid = true;
+            ntime_roll_offset = 0;
+        }
+    }
+    if (built) {
+        GLOBAL_STATE->SYSTEM_MODULE.jobs_built++;
+    }
+    return built;
+}
+
+// Top up the ring while waiting for the ASIC. SV2 standard jobs are sent once per
+// work item and are never prebuilt.
+static void job_ring_fill(job_ring *ring, GlobalState *GLOBAL_STATE, void *work, stratum_protocol_t protocol,
+                          double difficulty, uint64_t *extranonce_2)
+{
+    if (work == NULL || !GLOBAL_STATE->ASIC_initalized) return;
+    if (protocol == STRATUM_PROTOCOL_V2 && !stratum_v2_is_extended_channel(GLOBAL_STATE)) return;
+
+    while (ring->count < JOB_RING_SIZE) {
+        bm_job *job = &ring->jobs[(ring->head + ring->count) % JOB_RING_SIZE];
+        if (!build_next_job(GLOBAL_STATE, work, protocol, difficulty, extranonce_2, job)) break;
+        ring->count++;
+    }
+}
+
+static void send_job(GlobalState *GLOBAL_STATE, bm_job *job)
+{
+    // Check if ASIC is initialized before trying to send work
+    if (!GLOBAL_STATE->ASIC_initalized) {
+        ESP_LOGW(TAG, "ASIC not initialized, skipping job send");
+        return;
+    }
+
+    // send_work publishes the job into its job table slot
+    ASIC_send_work(GLOBAL_STATE, job);
+}
+
 void create_jobs_task(void *pvParameters)
 {
     GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
 
     // Initialize ASIC task module (moved from ASIC_task)
-    GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs = heap_caps_malloc(sizeof(bm_job *) * 128, MALLOC_CAP_SPIRAM);
-    GLOBAL_STATE->valid_jobs = heap_caps_malloc(sizeof(uint8_t) * 128, MALLOC_CAP_SPIRAM);
-    for (int i = 0; i < 128; i++) {
-        GLOBAL_STATE->ASIC_TASK_MODULE.active_jobs[i] = NULL;
-        GLOBAL_STATE->valid_jobs[i] = 0;
+    job_slot *job_slots = heap_caps_calloc(BM_JOB_POOL_SIZE, sizeof(job_slot), MALLOC_CAP_SPIRAM);
+    if (job_slots == NULL) {
+        // Without the table no job is ever sent, so the ASICs return no nonces to look up
+        ESP_LOGE(TAG, "Failed to allocate job table");
+        vTaskDelete(NULL);
+        return;
     }
+    job_table_init(&GLOBAL_STATE->ASIC_TASK_MODULE.jobs, job_slots);
 
     double difficulty = GLOBAL_STATE->pool_difficulty;
     void *current_work = NULL;
@@ -59,6 +222,12 @@ void create_jobs_task(void *pvParameters)
     uint64_t extranonce_2 = 0;
     int timeout_ms = ASIC_get_asic_job_frequency_ms(GLOBAL_STATE);
 
+#ifdef CONFIG_STRATUM_PARALLEL_MIDSTATES
+    if (!work_split_init()) {
+        ESP_LOGW(TAG, "Midstates will be computed on a single core");
+    }
+#endif
+
     ESP_LOGI(TAG, "ASIC Job Interval: %d ms", timeout_ms);
     ESP_LOGI(TAG, "ASIC Ready!");
 
@@ -74,6 +243,7 @@ void create_jobs_task(void *pvParameters)
                 ESP_LOGI(TAG, "Protocol switched from %s to %s, discarding current work",
                          current_work_protocol == STRATUM_PROTOCOL_V2 ? STRATUM_V2 : STRATUM_V1,
                          active_protocol == STRATUM_PROTOCOL_V2 ? STRATUM_V2 : STRATUM_V1);
+                job_ring_flush(&ready_jobs);
                 free_work_item(GLOBAL_STATE, current_work, current_work_protocol);
                 current_work = NULL;
             }
@@ -81,13 +251,17 @@ void create_jobs_task(void *pvParameters)
         }
 
         uint64_t start_time = esp_timer_get_time();
-        void *new_work = queue_dequeue_timeout(&GLOBAL_STATE->stratum_queue, timeout_ms);
+        // Hash the upcoming jobs now so the send after the timeout doesn't wait on SHA-256
+        job_ring_fill(&ready_jobs, GLOBAL_STATE, current_work, current_work_protocol, difficulty, &extranonce_2);
+        int wait_ms = timeout_ms - (int)((esp_timer_get_time() - start_time) / 1000);
+        void *new_work = queue_dequeue_timeout(&GLOBAL_STATE->stratum_queue, wait_ms > 0 ? wait_ms : 0);
         timeout_ms -= (esp_timer_get_time() - start_time) / 1000;
 
         if (new_work != NULL) {
             active_protocol = GLOBAL_STATE->stratum_protocol;
 
             // Free previous work using the protocol it was created under
+            job_ring_flush(&ready_jobs);
             free_work_item(GLOBAL_STATE, current_work, current_work_protocol);
             current_work = NULL;
 
@@ -108,11 +282,13 @@ void create_jobs_task(void *pvParameters)
             if (current_work_protocol == STRATUM_PROTOCOL_V2) {
                 if (stratum_v2_is_extended_channel(GLOBAL_STATE)) {
                     ESP_LOGI(TAG, "New Work Dequeued SV2 ext job %lu", ((sv2_ext_job_t *)new_work)->job_id);
+                    sv2_ext_coinbase_valid = prepare_sv2_ext_coinbase_template(GLOBAL_STATE, (sv2_ext_job_t *)new_work);
                 } else {
                     ESP_LOGI(TAG, "New Work Dequeued SV2 job %lu", ((sv2_job_t *)new_work)->job_id);
                 }
             } else {
                 ESP_LOGI(TAG, "New Work Dequeued %s", ((mining_notify *)new_work)->job_id);
+                v1_coinbase_valid = prepare_coinbase_template(GLOBAL_STATE, (mining_notify *)new_work);
             }
 
             current_work = new_work;
@@ -131,6 +307,10 @@ void create_jobs_task(void *pvParameters)
 
             extranonce_2 = 0;
 
+            uint16_t pool_idx = GLOBAL_STATE->SYSTEM_MODULE.is_using_fallback ? GLOBAL_STATE->SYSTEM_MODULE.secondary_pool_index : GLOBAL_STATE->SYSTEM_MODULE.primary_pool_index;
+            ntime_roll_enabled = GLOBAL_STATE->SYSTEM_MODULE.pools[pool_idx].ntime_roll;
+            ntime_roll_base_valid = false;
+
             // Check clean_jobs flag
             bool clean;
             if (current_work_protocol == STRATUM_PROTOCOL_V2) {
@@ -165,6 +345,7 @@ void create_jobs_task(void *pvParameters)
         // during a timeout dequeue while we still hold stale current_work
         active_protocol = GLOBAL_STATE->stratum_protocol;
         if (active_protocol != current_work_protocol) {
+            job_ring_flush(&ready_jobs);
             free_work_item(GLOBAL_STATE, current_work, current_work_protocol);
             current_work = NULL;
             current_work_protocol = active_protocol;
@@ -172,240 +353,52 @@ void create_jobs_task(void *pvParameters)
             continue;
         }
 
-        // Generate and send job
-        if (active_protocol == STRATUM_PROTOCOL_V2) {
-            if (stratum_v2_is_extended_channel(GLOBAL_STATE)) {
-                generate_work_sv2_ext(GLOBAL_STATE, (sv2_ext_job_t *)current_work, difficulty, extranonce_2);
-                extranonce_2++;
-            } else {
-                generate_work_sv2(GLOBAL_STATE, (sv2_job_t *)current_work, difficulty);
-            }
-        } else {
-            generate_work(GLOBAL_STATE, (mining_notify *)current_work, extranonce_2, difficulty);
-            extranonce_2++;
+        // Send a prebuilt job; right after new work the ring is empty and we build inline
+        bm_job *next_job = job_ring_pop(&ready_jobs);
+        if (next_job == NULL && build_next_job(GLOBAL_STATE, current_work, active_protocol, difficulty, &extranonce_2, &inline_job)) {
+            next_job = &inline_job;
+        }
+        if (next_job != NULL) {
+            send_job(GLOBAL_STATE, next_job);
         }
         timeout_ms = ASIC_get_asic_job_frequency_ms(GLOBAL_STATE);
     }
 }
 
-static void generate_work(GlobalState *GLOBAL_STATE, mining_notify *notification, uint64_t extranonce_2, double difficulty)
+static bool generate_work(GlobalState *GLOBAL_STATE, mining_notify *notification, uint64_t extranonce_2, double difficulty, bm_job *next_job)
 {
-    if (GLOBAL_STATE->extranonce_2_len > MAX_EXTRANONCE2_LEN) {
-        ESP_LOGE(TAG, "extranonce_2_len %d exceeds maximum %d, skipping job", GLOBAL_STATE->extranonce_2_len, MAX_EXTRANONCE2_LEN);
-        return;
+    if (!v1_coinbase_valid) {
+        ESP_LOGE(TAG, "No coinbase template for job %s, skipping job", notification->job_id);
+        return false;
     }
-    char extranonce_2_str[MAX_EXTRANONCE2_STR];
-    extranonce_2_generate(extranonce_2, GLOBAL_STATE->extranonce_2_len, extranonce_2_str);
 
-    uint8_t coinbase_tx_hash[32];
-    calculate_coinbase_tx_hash(notification->coinbase_1, notification->coinbase_2, GLOBAL_STATE->extranonce_str, extranonce_2_str, coinbase_tx_hash);
-
-    uint8_t merkle_root[32];
-    calculate_merkle_root_hash(coinbase_tx_hash, (uint8_t(*)[32])notification->merkle_branches, notification->n_merkle_branches, merkle_root);
-
-    bm_job *next_job = malloc(sizeof(bm_job));
-
-    if (next_job == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory for new job");
-        return;
-    }
-
-    construct_bm_job(notification, merkle_root, GLOBAL_STATE->version_mask, difficulty, next_job);
-
-    next_job->extranonce2 = strdup(extranonce_2_str);
-    next_job->jobid = strdup(notification->job_id);
-    next_job->version_mask = GLOBAL_STATE->version_mask;
-
-    // Check if ASIC is initialized before trying to send work
-    if (!GLOBAL_STATE->ASIC_initalized) {
-        // Clean up the job since we're not sending it
-        // Note: This job was never stored in active_jobs, so it's safe to free
-        ESP_LOGW(TAG, "ASIC not initialized, skipping job send");
-        free(next_job->jobid);
-        free(next_job->extranonce2);
-        free(next_job);
-        return;
-    }
-
-    ASIC_send_work(GLOBAL_STATE, next_job);
+    // Job id length was checked against BM_JOB_ID_SIZE when the template was prepared
+    construct_bm_job_v1(notification, &v1_coinbase, extranonce_2, GLOBAL_STATE->version_mask, difficulty, next_job);
+    return true;
 }
 
-// Construct bm_job directly from SV2 fields (no coinbase/merkle computation needed).
 // Standard channels rely on version rolling for unique work — the ASIC rolls the
 // version bits using version_mask, giving different midstates per nonce search space.
-static void generate_work_sv2(GlobalState *GLOBAL_STATE, sv2_job_t *sv2_job, double difficulty)
+static bool generate_work_sv2(GlobalState *GLOBAL_STATE, sv2_job_t *sv2_job, double difficulty, bm_job *next_job)
 {
-    bm_job *next_job = malloc(sizeof(bm_job));
-    if (next_job == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory for new SV2 job");
-        return;
-    }
-
-    uint32_t version_mask = GLOBAL_STATE->version_mask;
-
-    next_job->version = sv2_job->version;
-    next_job->target = sv2_job->nbits;
-    next_job->ntime = sv2_job->ntime;
-    next_job->starting_nonce = 0;
-    next_job->pool_diff = difficulty;
-
-    // SV2 provides merkle_root and prev_hash in internal byte order (SHA-256 output order).
-    // For bm_job storage: apply reverse_32bit_words (same as construct_bm_job does)
-    reverse_32bit_words(sv2_job->merkle_root, next_job->merkle_root);
-    reverse_32bit_words(sv2_job->prev_hash, next_job->prev_block_hash);
-
-    // Compute midstate(s) using the same logic as construct_bm_job.
-    // Midstate covers bytes 0-63 of block header: version(4B) + prev_hash(32B) + merkle_root[0:28](28B).
-    uint8_t midstate_data[64];
-    uint32_t base_version = sv2_job->version;
-    memcpy(midstate_data, &base_version, 4);
-    memcpy(midstate_data + 4, sv2_job->prev_hash, 32);
-    memcpy(midstate_data + 36, sv2_job->merkle_root, 28);
-
-    uint8_t midstate[32];
-    midstate_sha256_bin(midstate_data, 64, midstate);
-    reverse_32bit_words(midstate, next_job->midstate);
-
-    if (version_mask != 0) {
-        uint32_t rolled_version = increment_bitmask(base_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate1);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate2);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate3);
-        next_job->num_midstates = 4;
-    } else {
-        next_job->num_midstates = 1;
-    }
-
-    // SV2 job metadata
-    char jobid_str[16];
-    snprintf(jobid_str, sizeof(jobid_str), "%" PRIu32, sv2_job->job_id);
-    next_job->jobid = strdup(jobid_str);
-    next_job->extranonce2 = strdup(""); // unused in SV2 standard
-    next_job->version_mask = version_mask;
-
-    if (!GLOBAL_STATE->ASIC_initalized) {
-        ESP_LOGW(TAG, "ASIC not initialized, skipping SV2 job send");
-        free(next_job->jobid);
-        free(next_job->extranonce2);
-        free(next_job);
-        return;
-    }
-
-    ASIC_send_work(GLOBAL_STATE, next_job);
+    construct_bm_job_sv2(sv2_job->job_id, sv2_job->version, sv2_job->merkle_root, sv2_job->prev_hash,
+                         sv2_job->ntime, sv2_job->nbits, GLOBAL_STATE->version_mask, difficulty, next_job);
+    return true;
 }
 
-// Extended channel work generation: compute coinbase hash from prefix+extranonce+suffix,
-// then merkle root from merkle path, then midstates. extranonce_2 provides unique work.
-static void generate_work_sv2_ext(GlobalState *GLOBAL_STATE, sv2_ext_job_t *ext_job,
-                                   double difficulty, uint64_t extranonce_2_counter)
+// Extended channels get unique work from extranonce_2, patched into the channel's coinbase template
+static bool generate_work_sv2_ext(GlobalState *GLOBAL_STATE, sv2_ext_job_t *ext_job,
+                                  double difficulty, uint64_t extranonce_2_counter, bm_job *next_job)
 {
-    sv2_conn_t *conn = GLOBAL_STATE->sv2_conn;
-    if (!conn) return;
+    if (!GLOBAL_STATE->sv2_conn) return false;
 
-    bm_job *next_job = malloc(sizeof(bm_job));
-    if (!next_job) {
-        ESP_LOGE(TAG, "Failed to allocate memory for SV2 ext job");
-        return;
-    }
-
-    uint32_t version_mask = GLOBAL_STATE->version_mask;
-
-    // Derive extranonce_2 from counter
-    // SV2 spec: extranonce_size is the miner's rollable portion (not total)
-    uint8_t extranonce_2_len = conn->extranonce_size;
-    uint8_t extranonce_2[32];
-    memset(extranonce_2, 0, sizeof(extranonce_2));
-    // Encode counter as big-endian bytes
-    for (int i = extranonce_2_len - 1; i >= 0 && extranonce_2_counter > 0; i--) {
-        extranonce_2[i] = (uint8_t)(extranonce_2_counter & 0xFF);
-        extranonce_2_counter >>= 8;
-    }
-
-    // Compute coinbase tx hash: prefix + extranonce_prefix + extranonce_2 + suffix
-    uint8_t coinbase_tx_hash[32];
-    calculate_coinbase_tx_hash_bin(
-        ext_job->coinbase_prefix, ext_job->coinbase_prefix_len,
-        conn->extranonce_prefix, conn->extranonce_prefix_len,
-        extranonce_2, extranonce_2_len,
-        ext_job->coinbase_suffix, ext_job->coinbase_suffix_len,
-        coinbase_tx_hash);
-
-    // Compute merkle root
-    uint8_t merkle_root[32];
-    calculate_merkle_root_hash(coinbase_tx_hash,
-                               (const uint8_t (*)[32])ext_job->merkle_path,
-                               ext_job->merkle_path_count, merkle_root);
-
-    // Fill bm_job fields
-    next_job->version = ext_job->version;
-    next_job->target = ext_job->nbits;
-    next_job->ntime = ext_job->ntime;  // no offset — extranonce provides uniqueness
-    next_job->starting_nonce = 0;
-    next_job->pool_diff = difficulty;
-
-    // Same byte-order handling as generate_work_sv2
-    reverse_32bit_words(merkle_root, next_job->merkle_root);
-    reverse_32bit_words(ext_job->prev_hash, next_job->prev_block_hash);
-
-    // Compute midstate(s)
-    uint8_t midstate_data[64];
-    uint32_t base_version = ext_job->version;
-    memcpy(midstate_data, &base_version, 4);
-    memcpy(midstate_data + 4, ext_job->prev_hash, 32);
-    memcpy(midstate_data + 36, merkle_root, 28);
-
-    uint8_t midstate[32];
-    midstate_sha256_bin(midstate_data, 64, midstate);
-    reverse_32bit_words(midstate, next_job->midstate);
-
-    if (version_mask != 0) {
-        uint32_t rolled_version = increment_bitmask(base_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate1);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate2);
-
-        rolled_version = increment_bitmask(rolled_version, version_mask);
-        memcpy(midstate_data, &rolled_version, 4);
-        midstate_sha256_bin(midstate_data, 64, midstate);
-        reverse_32bit_words(midstate, next_job->midstate3);
-        next_job->num_midstates = 4;
-    } else {
-        next_job->num_midstates = 1;
-    }
-
-    // Job metadata
-    char jobid_str[16];
-    snprintf(jobid_str, sizeof(jobid_str), "%" PRIu32, ext_job->job_id);
-    next_job->jobid = strdup(jobid_str);
-
-    // Store extranonce_2 as hex for share submission
-    char en2_hex[65];
-    bin2hex(extranonce_2, extranonce_2_len, en2_hex, sizeof(en2_hex));
-    next_job->extranonce2 = strdup(en2_hex);
-    next_job->version_mask = version_mask;
-
-    if (!GLOBAL_STATE->ASIC_initalized) {
-        ESP_LOGW(TAG, "ASIC not initialized, skipping SV2 ext job send");
-        free(next_job->jobid);
-        free(next_job->extranonce2);
-        free(next_job);
-        return;
+    if (!sv2_ext_coinbase_valid) {
+        ESP_LOGE(TAG, "No coinbase template for SV2 ext job %lu, skipping job", ext_job->job_id);
+        return false;
     }
 
-    ASIC_send_work(GLOBAL_STATE, next_job);
+    construct_bm_job_sv2_ext(ext_job->job_id, ext_job->version, ext_job->prev_hash, ext_job->ntime, ext_job->nbits,
+                             (const uint8_t (*)[32])ext_job->merkle_path, ext_job->merkle_path_count,
+                             &sv2_ext_coinbase, extranonce_2_counter, GLOBAL_STATE->version_mask, difficulty, next_job);
+    return true;
 }
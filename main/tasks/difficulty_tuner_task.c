@@ -0,0 +1,85 @@
+#include <math.h>
+
+#include "difficulty_tuner_task.h"
+#include "global_state.h"
+#include "nvs_config.h"
+#include "mining.h"
+#include "stratum_v1_task.h"
+#include "stratum_v2_task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "difficulty_tuner";
+
+#define DIFFICULTY_TUNER_POLL_MS 30000
+// Leave the pool alone while its difficulty is within this factor of the target
+#define DIFFICULTY_TUNER_TOLERANCE 2.0
+// Pools may ignore or cap suggestions; don't repeat one more often than this
+#define DIFFICULTY_TUNER_MIN_INTERVAL_US (5 * 60 * 1000000LL)
+
+// The 10 minute average is steadier, but after a frequency change or a
+// restart the 1 minute average is the better estimate until it catches up
+static float estimate_hashrate(SystemModule *SYSTEM_MODULE)
+{
+    float hashrate_1m = SYSTEM_MODULE->hashrate_1m;
+    float hashrate_10m = SYSTEM_MODULE->hashrate_10m;
+
+    if (hashrate_10m <= 0.0f || isnanf(hashrate_10m)) return hashrate_1m;
+    if (hashrate_1m > hashrate_10m * DIFFICULTY_TUNER_TOLERANCE ||
+        hashrate_1m * DIFFICULTY_TUNER_TOLERANCE < hashrate_10m) {
+        return hashrate_1m;
+    }
+    return hashrate_10m;
+}
+
+static bool suggest_difficulty(GlobalState *GLOBAL_STATE, double difficulty, float hashrate_ghs)
+{
+    if (GLOBAL_STATE->stratum_protocol == STRATUM_PROTOCOL_V2) {
+        uint8_t max_target[32];
+        pdiff_to_target(difficulty, max_target);
+        return stratum_v2_update_channel(GLOBAL_STATE, hashrate_ghs * 1e9f, max_target) >= 0;
+    }
+    return stratum_v1_suggest_difficulty(GLOBAL_STATE, (uint32_t)difficulty) >= 0;
+}
+
+void difficulty_tuner_task(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    DifficultyTunerModule *module = &GLOBAL_STATE->DIFFICULTY_TUNER_MODULE;
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(DIFFICULTY_TUNER_POLL_MS));
+
+        uint16_t shares_per_minute = nvs_config_get_u16(NVS_CONFIG_TARGET_SHARE_RATE);
+        if (shares_per_minute == 0 || !GLOBAL_STATE->ASIC_initalized || GLOBAL_STATE->transport == NULL) {
+            continue;
+        }
+
+        float hashrate = estimate_hashrate(&GLOBAL_STATE->SYSTEM_MODULE);
+        double target = round(difficulty_for_share_rate(hashrate, shares_per_minute));
+        if (target < 1.0) {
+            continue;
+        }
+
+        double pool_difficulty = GLOBAL_STATE->pool_difficulty;
+        if (pool_difficulty > 0 && pool_difficulty <= target * DIFFICULTY_TUNER_TOLERANCE &&
+            pool_difficulty * DIFFICULTY_TUNER_TOLERANCE >= target) {
+            continue;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        if (module->suggestions > 0 && now_us - module->last_suggestion_us < DIFFICULTY_TUNER_MIN_INTERVAL_US) {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "Pool difficulty %g at %.1f GH/s, suggesting %g for %u shares/min",
+                 pool_difficulty, hashrate, target, shares_per_minute);
+        if (suggest_difficulty(GLOBAL_STATE, target, hashrate)) {
+            module->suggested_difficulty = target;
+            module->suggestions++;
+            module->last_suggestion_us = now_us;
+        } else {
+            ESP_LOGW(TAG, "Failed to send difficulty suggestion");
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef DIFFICULTY_TUNER_TASK_H_
+#define DIFFICULTY_TUNER_TASK_H_
+
+#include <stdint.h>
+
+// Steers the pool difficulty towards NVS_CONFIG_TARGET_SHARE_RATE shares per
+// minute from the measured hashrate: mining.suggest_difficulty on SV1,
+// UpdateChannel with a matching maximum target on SV2. 0 disables it.
+typedef struct {
+    double suggested_difficulty; // last difficulty asked for, 0 if none
+    uint32_t suggestions;
+    int64_t last_suggestion_us;
+} DifficultyTunerModule;
+
+void difficulty_tuner_task(void *pvParameters);
+
+#endif /* DIFFICULTY_TUNER_TASK_H_ */
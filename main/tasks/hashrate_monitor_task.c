@@ -14,6 +14,7 @@
 #define HASHRATE_UNIT 0x100000uLL // Hashrate register unit (2^24 hashes)
 
 #define POLL_RATE 1000
+#define READBACK_TIMEOUT_MS 100
 #define HASHRATE_1M_SIZE (60000 / POLL_RATE)  // 12
 #define HASHRATE_10M_SIZE 10
 #define HASHRATE_1H_SIZE 6
@@ -87,6 +88,63 @@ void update_hash_counter(measurement_t * measurement, uint32_t value, uint64_t t
     measurement->time_us = time_us;
 }
 
+static void start_readback(GlobalState * GLOBAL_STATE, int asic_count)
+{
+    HashrateMonitorModule * HASHRATE_MONITOR_MODULE = &GLOBAL_STATE->HASHRATE_MONITOR_MODULE;
+
+    // Drop a completion left over from a cycle that finished after its timeout
+    xSemaphoreTake(HASHRATE_MONITOR_MODULE->readback_done, 0);
+
+    // Armed before the send so no reply can arrive ahead of it; the send itself runs
+    // unlocked so the result task never waits on the UART to record a register
+    pthread_mutex_lock(&HASHRATE_MONITOR_MODULE->lock);
+    memset(HASHRATE_MONITOR_MODULE->readback_received, 0, asic_count * sizeof(uint16_t));
+    HASHRATE_MONITOR_MODULE->readback_pending = asic_count;
+    HASHRATE_MONITOR_MODULE->readback_start_us = esp_timer_get_time();
+    HASHRATE_MONITOR_MODULE->readback_requested = ASIC_read_register_mask(GLOBAL_STATE);
+    pthread_mutex_unlock(&HASHRATE_MONITOR_MODULE->lock);
+
+    ASIC_read_registers(GLOBAL_STATE);
+}
+
+static void wait_readback(HashrateMonitorModule * HASHRATE_MONITOR_MODULE)
+{
+    if (xSemaphoreTake(HASHRATE_MONITOR_MODULE->readback_done, pdMS_TO_TICKS(READBACK_TIMEOUT_MS)) == pdTRUE) {
+        return;
+    }
+
+    pthread_mutex_lock(&HASHRATE_MONITOR_MODULE->lock);
+    int pending = HASHRATE_MONITOR_MODULE->readback_pending;
+    HASHRATE_MONITOR_MODULE->readback_pending = 0;
+    pthread_mutex_unlock(&HASHRATE_MONITOR_MODULE->lock);
+
+    if (pending > 0) {
+        HASHRATE_MONITOR_MODULE->readback_timeouts++;
+        ESP_LOGD(TAG, "Register readback timed out, %d ASIC(s) incomplete", pending);
+    }
+}
+
+// Must be called with the lock held
+static void track_readback(HashrateMonitorModule * HASHRATE_MONITOR_MODULE, register_type_t register_type, uint8_t asic_nr, uint64_t timestamp_us)
+{
+    uint16_t requested = HASHRATE_MONITOR_MODULE->readback_requested;
+    if (HASHRATE_MONITOR_MODULE->readback_pending == 0 || !(requested & (1 << register_type))) return;
+
+    uint16_t received = HASHRATE_MONITOR_MODULE->readback_received[asic_nr];
+    if (received == requested) return;
+
+    received |= 1 << register_type;
+    HASHRATE_MONITOR_MODULE->readback_received[asic_nr] = received;
+    if (received != requested || --HASHRATE_MONITOR_MODULE->readback_pending > 0) return;
+
+    float latency_ms = (timestamp_us - HASHRATE_MONITOR_MODULE->readback_start_us) / 1000.0f;
+    HASHRATE_MONITOR_MODULE->readback_latency_ms = latency_ms;
+    if (latency_ms > HASHRATE_MONITOR_MODULE->readback_latency_max_ms) {
+        HASHRATE_MONITOR_MODULE->readback_latency_max_ms = latency_ms;
+    }
+    xSemaphoreGive(HASHRATE_MONITOR_MODULE->readback_done);
+}
+
 static void init_averages()
 {
     float nan_val = nanf("");
@@ -157,6 +215,8 @@ void hashrate_monitor_task(void *pvParameters)
         HASHRATE_MONITOR_MODULE->domain_measurements[asic_nr] = data + (asic_nr * hash_domains);
     }
     HASHRATE_MONITOR_MODULE->error_measurement = heap_caps_malloc(asic_count * sizeof(measurement_t), MALLOC_CAP_SPIRAM);
+    HASHRATE_MONITOR_MODULE->readback_received = heap_caps_calloc(asic_count, sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    HASHRATE_MONITOR_MODULE->readback_done = xSemaphoreCreateBinary();
 
     pthread_mutex_init(&HASHRATE_MONITOR_MODULE->lock, NULL);
     HASHRATE_MONITOR_MODULE->is_initialized = true;
@@ -180,8 +240,8 @@ void hashrate_monitor_task(void *pvParameters)
         was_asic_initialized = is_asic_initialized;
 
         if (is_asic_initialized) {
-            ASIC_read_registers(GLOBAL_STATE);
-            vTaskDelay(100 / portTICK_PERIOD_MS);
+            start_readback(GLOBAL_STATE, asic_count);
+            wait_readback(HASHRATE_MONITOR_MODULE);
 
             pthread_mutex_lock(&HASHRATE_MONITOR_MODULE->lock);
             float current_hashrate = sum_hashrates(HASHRATE_MONITOR_MODULE->total_measurement, asic_count);
@@ -214,6 +274,8 @@ void hashrate_monitor_register_read(void *pvParameters, register_type_t register
 
     pthread_mutex_lock(&HASHRATE_MONITOR_MODULE->lock);
 
+    track_readback(HASHRATE_MONITOR_MODULE, register_type, asic_nr, timestamp_us);
+
     switch(register_type) {
         case REGISTER_HASHRATE:
             update_hashrate(&HASHRATE_MONITOR_MODULE->total_measurement[asic_nr], value);
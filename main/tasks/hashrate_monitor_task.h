@@ -3,6 +3,8 @@
 
 #include "asic_common.h"
 #include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 typedef struct {
     uint32_t value;
@@ -15,6 +17,17 @@ typedef struct {
     measurement_t** domain_measurements;
     measurement_t* error_measurement;
 
+    // Register readback cycle: replies are matched by (asic, register) until
+    // every chip has answered every register read in the burst
+    uint16_t readback_requested;  // (1 << register_type) bits
+    uint16_t *readback_received;  // per ASIC
+    int readback_pending;         // ASICs still missing a reply
+    uint64_t readback_start_us;
+    SemaphoreHandle_t readback_done;
+    float readback_latency_ms;    // last completed cycle
+    float readback_latency_max_ms;
+    uint32_t readback_timeouts;
+
     pthread_mutex_t lock;
     bool is_initialized;
 } HashrateMonitorModule;
@@ -1,19 +1,62 @@
 #include "scoreboard.h"
 #include "nvs_config.h"
 #include "esp_log.h"
+#include "nvs.h"
+#include <stddef.h>
 #include <stdio.h>
 
+#define SCOREBOARD_NVS_KEY "scoreboard_bin"
+#define SCOREBOARD_BLOB_VERSION 1
+
+// Changes are written this long after the last one, but never later than
+// SCOREBOARD_SAVE_MAX_DELAY_MS after the first unsaved one
+#define SCOREBOARD_SAVE_DEBOUNCE_MS 10000
+#define SCOREBOARD_SAVE_MAX_DELAY_MS 60000
+
 static const char * TAG = "scoreboard";
 
-esp_err_t scoreboard_init(Scoreboard *scoreboard)
+// Bump SCOREBOARD_BLOB_VERSION whenever ScoreboardEntry changes layout
+typedef struct {
+    uint32_t version;
+    uint32_t count;
+    ScoreboardEntry entries[MAX_SCOREBOARD];
+} ScoreboardBlob;
+
+static void terminate_strings(ScoreboardEntry *entry)
 {
-    scoreboard->count = 0;
-    scoreboard->mutex = xSemaphoreCreateMutex();
-    if (scoreboard->mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return ESP_FAIL;
+    entry->job_id[sizeof(entry->job_id) - 1] = '\0';
+    entry->extranonce2[sizeof(entry->extranonce2) - 1] = '\0';
+}
+
+static bool scoreboard_load(Scoreboard *scoreboard)
+{
+    ScoreboardBlob *blob = malloc(sizeof(ScoreboardBlob));
+    if (blob == NULL) return false;
+
+    size_t len = sizeof(ScoreboardBlob);
+    esp_err_t err = nvs_config_get_blob(SCOREBOARD_NVS_KEY, blob, &len);
+    bool loaded = false;
+    if (err == ESP_OK) {
+        if (len < offsetof(ScoreboardBlob, entries) || blob->version != SCOREBOARD_BLOB_VERSION ||
+            blob->count > MAX_SCOREBOARD || len != offsetof(ScoreboardBlob, entries) + blob->count * sizeof(ScoreboardEntry)) {
+            ESP_LOGW(TAG, "Ignoring scoreboard blob (version %lu, %u bytes)", len >= sizeof(uint32_t) ? blob->version : 0, (unsigned int)len);
+        } else {
+            for (uint32_t i = 0; i < blob->count; i++) {
+                terminate_strings(&blob->entries[i]);
+                scoreboard->entries[i] = blob->entries[i];
+            }
+            scoreboard->count = blob->count;
+            loaded = true;
+        }
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Failed to read scoreboard blob: %s", esp_err_to_name(err));
     }
+    free(blob);
+    return loaded;
+}
 
+static void scoreboard_load_legacy(Scoreboard *scoreboard)
+{
     for (int i = 0; i < MAX_SCOREBOARD; i++) {
         char *entry_str = nvs_config_get_string_indexed(NVS_CONFIG_SCOREBOARD, i);
         if (entry_str == NULL || entry_str[0] == '\0') {
@@ -22,36 +65,120 @@ esp_err_t scoreboard_init(Scoreboard *scoreboard)
         }
 
         ScoreboardEntry entry;
-        if (sscanf(entry_str, "%lf;%31[^;];%31[^;];%lu;%lu;%lu", 
-                   &entry.difficulty, 
-                   entry.job_id, 
-                   entry.extranonce2, 
-                   &entry.ntime, 
-                   &entry.nonce, 
+        if (sscanf(entry_str, "%lf;%31[^;];%31[^;];%lu;%lu;%lu",
+                   &entry.difficulty,
+                   entry.job_id,
+                   entry.extranonce2,
+                   &entry.ntime,
+                   &entry.nonce,
                    &entry.version_bits) == 6) {
-            strncpy(entry.nvs_entry, entry_str, sizeof(entry.nvs_entry) - 1);
-            entry.nvs_entry[sizeof(entry.nvs_entry) - 1] = '\0';
             scoreboard->entries[scoreboard->count++] = entry;
         } else {
             ESP_LOGW(TAG, "Failed to parse scoreboard entry from NVS: %s", entry_str);
         }
         free(entry_str);
     }
+}
+
+// Must be called with the mutex held
+static void scoreboard_mark_dirty(Scoreboard *scoreboard)
+{
+    TickType_t now = xTaskGetTickCount();
+    if (!scoreboard->dirty) {
+        scoreboard->dirty = true;
+        scoreboard->dirty_since = now;
+    } else if (now - scoreboard->dirty_since >= pdMS_TO_TICKS(SCOREBOARD_SAVE_MAX_DELAY_MS)) {
+        return; // Let the pending timer fire
+    }
+    xTimerReset(scoreboard->save_timer, 0);
+}
+
+// Runs in the timer service task, so it must not block: on contention or a
+// full NVS queue it simply tries again after another debounce period
+static void scoreboard_save_callback(TimerHandle_t timer)
+{
+    Scoreboard *scoreboard = pvTimerGetTimerID(timer);
+
+    ScoreboardBlob *blob = malloc(sizeof(ScoreboardBlob));
+    if (blob == NULL || xSemaphoreTake(scoreboard->mutex, 0) != pdTRUE) {
+        free(blob);
+        xTimerReset(timer, 0);
+        return;
+    }
+    blob->version = SCOREBOARD_BLOB_VERSION;
+    blob->count = scoreboard->count;
+    memcpy(blob->entries, scoreboard->entries, scoreboard->count * sizeof(ScoreboardEntry));
+    scoreboard->dirty = false;
+    xSemaphoreGive(scoreboard->mutex);
+
+    esp_err_t err = nvs_config_set_blob(SCOREBOARD_NVS_KEY, blob, offsetof(ScoreboardBlob, entries) + blob->count * sizeof(ScoreboardEntry));
+    free(blob);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to queue scoreboard save: %s", esp_err_to_name(err));
+        if (xSemaphoreTake(scoreboard->mutex, 0) == pdTRUE) {
+            scoreboard_mark_dirty(scoreboard);
+            xSemaphoreGive(scoreboard->mutex);
+        } else {
+            xTimerReset(timer, 0);
+        }
+    }
+}
+
+esp_err_t scoreboard_init(Scoreboard *scoreboard)
+{
+    scoreboard->count = 0;
+    scoreboard->dirty = false;
+    scoreboard->mutex = xSemaphoreCreateMutex();
+    if (scoreboard->mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return ESP_FAIL;
+    }
+
+    scoreboard->save_timer = xTimerCreate("scoreboard_save", pdMS_TO_TICKS(SCOREBOARD_SAVE_DEBOUNCE_MS), pdFALSE, scoreboard, scoreboard_save_callback);
+    if (scoreboard->save_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create save timer");
+        return ESP_FAIL;
+    }
+
+    if (!scoreboard_load(scoreboard)) {
+        // The indexed strings are left in place so older firmware still finds them
+        scoreboard_load_legacy(scoreboard);
+        if (scoreboard->count > 0) {
+            ESP_LOGI(TAG, "Migrating %d scoreboard entries to %s", scoreboard->count, SCOREBOARD_NVS_KEY);
+            scoreboard_mark_dirty(scoreboard);
+        }
+    }
     return ESP_OK;
 }
 
-static void scoreboard_save(int i, ScoreboardEntry *entry)
+double scoreboard_min_difficulty(const Scoreboard *scoreboard)
+{
+    if (scoreboard->count < MAX_SCOREBOARD) return 0.0;
+    return scoreboard->entries[MAX_SCOREBOARD - 1].difficulty;
+}
+
+// First position whose difficulty is lower, so ties keep their original order
+static int scoreboard_find_position(const Scoreboard *scoreboard, double difficulty)
 {
-    nvs_config_set_string_indexed(NVS_CONFIG_SCOREBOARD, i, entry->nvs_entry);
+    int lo = 0;
+    int hi = scoreboard->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (scoreboard->entries[mid].difficulty >= difficulty) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
 esp_err_t scoreboard_add(Scoreboard *scoreboard, double difficulty, const char *job_id, const char *extranonce2, uint32_t ntime, uint32_t nonce, uint32_t version_bits)
 {
     if (scoreboard->mutex == NULL) return ESP_OK;
 
-    int i = (scoreboard->count < MAX_SCOREBOARD) ? scoreboard->count : MAX_SCOREBOARD - 1;
-
-    if (scoreboard->count == MAX_SCOREBOARD && i >= 0 && difficulty <= scoreboard->entries[i].difficulty) {
+    if (scoreboard->count == MAX_SCOREBOARD && difficulty <= scoreboard->entries[MAX_SCOREBOARD - 1].difficulty) {
         return ESP_OK;
     }
 
@@ -62,36 +189,29 @@ esp_err_t scoreboard_add(Scoreboard *scoreboard, double difficulty, const char *
         .version_bits = version_bits,
     };
     strncpy(new_entry.job_id, job_id, sizeof(new_entry.job_id) - 1);
-    new_entry.job_id[sizeof(new_entry.job_id) - 1] = '\0';
     strncpy(new_entry.extranonce2, extranonce2, sizeof(new_entry.extranonce2) - 1);
-    new_entry.extranonce2[sizeof(new_entry.extranonce2) - 1] = '\0';
-    snprintf(new_entry.nvs_entry, sizeof(new_entry.nvs_entry),
-        "%.1f;%s;%s;%lu;%lu;%lu", 
-        new_entry.difficulty, 
-        new_entry.job_id, 
-        new_entry.extranonce2,
-        new_entry.ntime,
-        new_entry.nonce,
-        new_entry.version_bits);
 
+    int i;
     if (xSemaphoreTake(scoreboard->mutex, portMAX_DELAY) == pdTRUE) {
-        while (i > 0 && difficulty > scoreboard->entries[i - 1].difficulty) {
-            scoreboard->entries[i] = scoreboard->entries[i - 1];
-            scoreboard_save(i, &scoreboard->entries[i]);
-            i--;
+        i = scoreboard_find_position(scoreboard, difficulty);
+        if (i >= MAX_SCOREBOARD) {
+            xSemaphoreGive(scoreboard->mutex);
+            return ESP_OK;
         }
-    
+
+        int last = (scoreboard->count < MAX_SCOREBOARD) ? scoreboard->count : MAX_SCOREBOARD - 1;
+        memmove(&scoreboard->entries[i + 1], &scoreboard->entries[i], (last - i) * sizeof(ScoreboardEntry));
         scoreboard->entries[i] = new_entry;
-        scoreboard_save(i, &new_entry);
         if (scoreboard->count < MAX_SCOREBOARD) {
             scoreboard->count++;
         }
+        scoreboard_mark_dirty(scoreboard);
         xSemaphoreGive(scoreboard->mutex);
     } else {
         ESP_LOGE(TAG, "Failed to take mutex");
         return ESP_FAIL;
     }
-    
+
     ESP_LOGI(TAG, "New #%d: Difficulty: %.1f, Job ID: %s, extranonce2: %s, ntime: %d, nonce: %08X, version_bits: %08X",
         i+1, new_entry.difficulty, new_entry.job_id, new_entry.extranonce2, new_entry.ntime, (unsigned int)new_entry.nonce, (unsigned int)new_entry.version_bits);
 
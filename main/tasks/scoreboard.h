@@ -2,11 +2,13 @@
 #define SCOREBOARD_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <time.h>
 #include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/timers.h"
 #include "esp_err.h"
 
 #define MAX_SCOREBOARD 20
@@ -18,16 +20,20 @@ typedef struct {
     uint32_t ntime;
     uint32_t nonce;
     uint32_t version_bits;
-    char nvs_entry[128];
 } ScoreboardEntry;
 
 typedef struct {
-    ScoreboardEntry entries[MAX_SCOREBOARD];
+    ScoreboardEntry entries[MAX_SCOREBOARD]; // Highest difficulty first
     int count;
     SemaphoreHandle_t mutex;
+    TimerHandle_t save_timer; // Debounces NVS writes after changes
+    bool dirty;
+    TickType_t dirty_since;
 } Scoreboard;
 
 esp_err_t scoreboard_init(Scoreboard *scoreboard);
+// Lowest difficulty that can still enter the scoreboard, 0 while it is not full
+double scoreboard_min_difficulty(const Scoreboard *scoreboard);
 esp_err_t scoreboard_add(Scoreboard *scoreboard, double difficulty, const char *job_id, const char *extranonce2, uint32_t ntime, uint32_t nonce, uint32_t version_bits);
 
 #endif /* SCOREBOARD_H */
@@ -0,0 +1,260 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "share_submit_task.h"
+#include "global_state.h"
+#include "stratum_api.h"
+#include "stratum_v2_task.h"
+#include "sv2_protocol.h"
+#include "utils.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "share_submit";
+
+// Weight of the newest sample in the latency moving average
+#define LATENCY_EMA_ALPHA 0.1f
+
+// Room for one mining.submit message
+#define SHARE_V1_MSG_SIZE 1024
+// Largest SubmitShares frame (extended, 32-byte extranonce)
+#define SHARE_V2_FRAME_SIZE (SV2_FRAME_HEADER_SIZE + 24 + 1 + 32)
+
+bool share_submit_init(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    ShareSubmitModule *module = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+
+    share_filter_init(&module->recent_shares);
+    module->queue = xQueueCreate(SHARE_QUEUE_LENGTH + SHARE_BLOCK_RESERVED_SLOTS, sizeof(share_record));
+    module->batch_buf = malloc(SHARE_BATCH_MAX * SHARE_V1_MSG_SIZE);
+    if (module->queue == NULL || module->batch_buf == NULL) {
+        ESP_LOGE(TAG, "Failed to create share queue");
+        return false;
+    }
+    return true;
+}
+
+bool share_submit_enqueue(void *pvParameters, const share_record *share)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    ShareSubmitModule *module = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+
+    // ASIC_result_task is the only producer, so the free space can only grow
+    // between the check and the send
+    BaseType_t queued = pdFALSE;
+    if (module->queue != NULL) {
+        if (share->block) {
+            queued = xQueueSendToFront(module->queue, share, 0);
+        } else if (uxQueueSpacesAvailable(module->queue) > SHARE_BLOCK_RESERVED_SLOTS) {
+            queued = xQueueSend(module->queue, share, 0);
+        }
+    }
+    if (queued != pdTRUE) {
+        if (share->block) {
+            // Only possible with earlier block solutions still unsent in every reserved slot
+            module->blocks_dropped++;
+            ESP_LOGE(TAG, "Share queue full, dropping block solution (job %s, nonce %08" PRIX32 ")", share->jobid, share->nonce);
+        } else {
+            module->dropped_full++;
+            ESP_LOGW(TAG, "Share queue full, dropping share (job %s, nonce %08" PRIX32 ")", share->jobid, share->nonce);
+        }
+        return false;
+    }
+
+    module->enqueued++;
+    uint32_t depth = uxQueueMessagesWaiting(module->queue);
+    if (depth > module->queue_high_water) {
+        module->queue_high_water = depth;
+    }
+    return true;
+}
+
+uint32_t share_submit_queue_depth(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    QueueHandle_t queue = GLOBAL_STATE->SHARE_SUBMIT_MODULE.queue;
+    return queue ? uxQueueMessagesWaiting(queue) : 0;
+}
+
+// Sends shares[0..*count) as newline-delimited mining.submit messages in one
+// write. Shares that cannot be formatted are dropped and *count reduced.
+static int send_shares_v1(GlobalState *GLOBAL_STATE, share_record *shares, int *count, uint64_t *sent_time_us)
+{
+    ShareSubmitModule *module = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+    uint16_t active_idx = GLOBAL_STATE->SYSTEM_MODULE.is_using_fallback ? GLOBAL_STATE->SYSTEM_MODULE.secondary_pool_index : GLOBAL_STATE->SYSTEM_MODULE.primary_pool_index;
+    char *user = GLOBAL_STATE->SYSTEM_MODULE.pools[active_idx].user;
+
+    taskENTER_CRITICAL(&GLOBAL_STATE->stratum_mux);
+    esp_transport_handle_t transport = GLOBAL_STATE->transport;
+    int first_uid = GLOBAL_STATE->send_uid;
+    GLOBAL_STATE->send_uid += *count;
+    taskEXIT_CRITICAL(&GLOBAL_STATE->stratum_mux);
+
+    if (transport == NULL) {
+        ESP_LOGW(TAG, "No stratum connection, dropping %d share(s) (job %s)", *count, shares[0].jobid);
+        return -ENOTCONN;
+    }
+
+    int uids[SHARE_BATCH_MAX];
+    int sent = 0;
+    size_t len = 0;
+    for (int i = 0; i < *count; i++) {
+        char extranonce2[BM_JOB_EXTRANONCE2_SIZE];
+        bin2hex(shares[i].extranonce2, shares[i].extranonce2_len, extranonce2, sizeof(extranonce2));
+
+        // The buffer has a SHARE_V1_MSG_SIZE slot per share, so only an oversized message fails
+        int msg_len = STRATUM_V1_format_submit(module->batch_buf + len, SHARE_BATCH_MAX * SHARE_V1_MSG_SIZE - len,
+                                               first_uid + i, user, shares[i].jobid, extranonce2,
+                                               shares[i].ntime, shares[i].nonce, shares[i].version_bits);
+        if (msg_len < 0) {
+            ESP_LOGE(TAG, "mining.submit too long, dropping share (job %s)", shares[i].jobid);
+            module->send_errors++;
+            continue;
+        }
+        uids[sent] = first_uid + i;
+        shares[sent++] = shares[i];
+        len += msg_len;
+    }
+    *count = sent;
+    if (sent == 0) {
+        return 0;
+    }
+
+    int ret = STRATUM_V1_submit_batch(transport, module->batch_buf, len, uids, sent, sent_time_us);
+    if (ret < 0) {
+        // stratum_task recv loop will detect a broken connection on its next read and handle reconnection
+        ESP_LOGW(TAG, "Unable to write share(s) to socket (ret: %d, errno %d: %s)", ret, errno, strerror(errno));
+    }
+    return ret;
+}
+
+// Sends shares[0..count) as back-to-back SubmitShares frames in one write
+static int send_shares_v2(GlobalState *GLOBAL_STATE, const share_record *shares, int count, uint64_t *sent_time_us)
+{
+    uint8_t frames[SHARE_BATCH_MAX * SHARE_V2_FRAME_SIZE];
+    int len = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t sv2_job_id = (uint32_t)strtoul(shares[i].jobid, NULL, 10);
+        int frame_len = stratum_v2_build_share_frame(GLOBAL_STATE, frames + len, SHARE_V2_FRAME_SIZE,
+                                                     sv2_job_id, shares[i].nonce, shares[i].ntime, shares[i].version,
+                                                     shares[i].extranonce2, shares[i].extranonce2_len);
+        if (frame_len < 0) {
+            return -ENOTCONN;
+        }
+        len += frame_len;
+    }
+
+    int ret = stratum_v2_send_frames(GLOBAL_STATE, frames, len);
+    *sent_time_us = esp_timer_get_time();
+
+    if (ret < 0) {
+        ESP_LOGW(TAG, "Failed to submit SV2 share(s) (ret=%d, errno=%d: %s)", ret, errno, strerror(errno));
+    }
+    return ret;
+}
+
+static void record_latency(ShareSubmitModule *module, float latency_ms)
+{
+    module->last_latency_ms = latency_ms;
+    module->avg_latency_ms = module->sent == 1 ? latency_ms
+        : module->avg_latency_ms + LATENCY_EMA_ALPHA * (latency_ms - module->avg_latency_ms);
+    if (latency_ms > module->max_latency_ms) {
+        module->max_latency_ms = latency_ms;
+    }
+}
+
+// Drops shares found under a protocol that is no longer active and sends the
+// rest in one write
+static void send_batch(GlobalState *GLOBAL_STATE, share_record *shares, int count)
+{
+    ShareSubmitModule *module = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+
+    // The job ids and extranonce2 belong to the connection the shares were found under
+    int live = 0;
+    for (int i = 0; i < count; i++) {
+        if (shares[i].protocol != GLOBAL_STATE->stratum_protocol) {
+            module->dropped_stale++;
+            ESP_LOGW(TAG, "Protocol changed, dropping share (job %s)", shares[i].jobid);
+            continue;
+        }
+        if (shares[i].connection != module->connection_generation) {
+            module->dropped_stale++;
+            ESP_LOGW(TAG, "Pool reconnected, dropping share (job %s)", shares[i].jobid);
+            continue;
+        }
+        shares[live++] = shares[i];
+    }
+    if (live == 0) {
+        return;
+    }
+
+    uint64_t sent_time_us = 0;
+    int ret = GLOBAL_STATE->stratum_protocol == STRATUM_PROTOCOL_V2
+        ? send_shares_v2(GLOBAL_STATE, shares, live, &sent_time_us)
+        : send_shares_v1(GLOBAL_STATE, shares, &live, &sent_time_us);
+
+    if (ret == -ENOTCONN) {
+        module->dropped_stale += live;
+        return;
+    }
+    if (ret < 0) {
+        module->send_errors += live;
+        return;
+    }
+    if (live == 0) {
+        return;
+    }
+
+    for (int i = 0; i < live; i++) {
+        module->sent++;
+        record_latency(module, (sent_time_us - shares[i].enqueued_time_us) / 1000.0f);
+        if (shares[i].block) {
+            module->blocks_sent++;
+            module->block_latency_ms = (sent_time_us - shares[i].found_time_us) / 1000.0f;
+            ESP_LOGI(TAG, "Block solution sent %0.1f ms after the ASIC found it (job %s)", module->block_latency_ms, shares[i].jobid);
+        }
+    }
+    module->batches++;
+
+    float process_time = (sent_time_us - shares[0].found_time_us) / 1000.0f;
+    GLOBAL_STATE->SYSTEM_MODULE.process_time = process_time;
+    ESP_LOGI(TAG, "Processing time: %0.1f ms (%d share%s)", process_time, live, live == 1 ? "" : "s");
+}
+
+void share_submit_task(void *pvParameters)
+{
+    GlobalState *GLOBAL_STATE = (GlobalState *)pvParameters;
+    ShareSubmitModule *module = &GLOBAL_STATE->SHARE_SUBMIT_MODULE;
+    const TickType_t window = pdMS_TO_TICKS(CONFIG_SHARE_SUBMIT_COALESCE_MS);
+    share_record shares[SHARE_BATCH_MAX];
+
+    while (1) {
+        if (xQueueReceive(module->queue, &shares[0], portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        // Collect whatever else arrives within the window after the first share.
+        // A block solution ends the window and goes out first.
+        TickType_t window_start = xTaskGetTickCount();
+        int count = 1;
+        while (count < SHARE_BATCH_MAX && !shares[count - 1].block) {
+            TickType_t elapsed = xTaskGetTickCount() - window_start;
+            TickType_t remaining = elapsed < window ? window - elapsed : 0;
+            if (xQueueReceive(module->queue, &shares[count], remaining) != pdTRUE) {
+                break;
+            }
+            count++;
+        }
+        if (count > 1 && shares[count - 1].block) {
+            share_record block = shares[count - 1];
+            shares[count - 1] = shares[0];
+            shares[0] = block;
+        }
+
+        send_batch(GLOBAL_STATE, shares, count);
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef SHARE_SUBMIT_TASK_H_
+#define SHARE_SUBMIT_TASK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "mining.h"
+#include "share_filter.h"
+
+#define SHARE_QUEUE_LENGTH 32
+// Queue slots only a block solution may take, on top of SHARE_QUEUE_LENGTH
+#define SHARE_BLOCK_RESERVED_SLOTS 1
+// Most shares coalesced into one write
+#define SHARE_BATCH_MAX 8
+
+// Everything needed to put one share on the wire, copied out of the job so
+// the job slot can be reused while the share waits in the queue
+typedef struct {
+    uint8_t protocol;              // stratum_protocol_t the job was built under
+    uint32_t connection;           // ShareSubmitModule.connection_generation at intake
+    char jobid[BM_JOB_ID_SIZE];
+    uint8_t extranonce2[32];
+    uint8_t extranonce2_len;
+    uint32_t ntime;
+    uint32_t nonce;
+    uint32_t version;              // full rolled version (SV2)
+    uint32_t version_bits;         // rolled bits only (SV1)
+    bool block;                    // meets the network target: front of the queue, no coalescing
+    uint64_t found_time_us;        // ASIC result timestamp
+    uint64_t enqueued_time_us;
+} share_record;
+
+typedef struct {
+    QueueHandle_t queue;
+    uint32_t connection_generation; // bumped on every pool connect, see SYSTEM_notify_pool_connected()
+    char *batch_buf;               // SHARE_BATCH_MAX mining.submit messages
+    uint32_t queue_high_water;
+    uint64_t enqueued;
+    uint64_t sent;
+    uint64_t batches;              // writes carrying sent shares
+    uint64_t dropped_full;         // queue full, share lost at intake
+    uint64_t dropped_stale;        // protocol switched, pool reconnected or no connection when dequeued
+    uint64_t send_errors;
+    uint64_t duplicates;           // suppressed by recent_shares, never sent
+    share_filter recent_shares;    // owned by ASIC_result_task
+    float last_latency_ms;         // enqueue to wire
+    float avg_latency_ms;          // exponential moving average
+    float max_latency_ms;
+    uint32_t blocks_sent;
+    uint32_t blocks_dropped;       // block solutions lost at intake, not counted in dropped_full
+    float block_latency_ms;        // ASIC result to wire, last block solution
+} ShareSubmitModule;
+
+bool share_submit_init(void *pvParameters);
+
+// Never blocks: a full queue drops the share and counts it. Block solutions
+// go to the front of the queue and can use the reserved slots ordinary shares
+// leave free, so they are never turned away by a backlog of ordinary shares.
+bool share_submit_enqueue(void *pvParameters, const share_record *share);
+
+uint32_t share_submit_queue_depth(void *pvParameters);
+
+void share_submit_task(void *pvParameters);
+
+#endif /* SHARE_SUBMIT_TASK_H_ */
@@ -55,6 +55,17 @@ static int stratum_get_next_uid(GlobalState * GLOBAL_STATE)
 }
 
 
+int stratum_v1_suggest_difficulty(GlobalState *GLOBAL_STATE, uint32_t difficulty)
+{
+    taskENTER_CRITICAL(&GLOBAL_STATE->stratum_mux);
+    esp_transport_handle_t transport = GLOBAL_STATE->transport;
+    int uid = GLOBAL_STATE->send_uid++;
+    taskEXIT_CRITICAL(&GLOBAL_STATE->stratum_mux);
+
+    if (transport == NULL) return -1;
+    return STRATUM_V1_suggest_difficulty(transport, uid, difficulty);
+}
+
 static void stratum_v1_reset_uid(GlobalState *GLOBAL_STATE)
 {
     ESP_LOGI(TAG, "Resetting stratum uid");
@@ -284,6 +295,7 @@ void stratum_v1_task(void *pvParameters)
 
         stratum_v1_reset_uid(GLOBAL_STATE);
         SYSTEM_clean_jobs_queue(GLOBAL_STATE);
+        SYSTEM_notify_pool_connected(GLOBAL_STATE, STRATUM_PROTOCOL_V1);
 
         ///// Start Stratum Action
         // mining.configure - ID: 1
@@ -343,6 +355,7 @@ void stratum_v1_task(void *pvParameters)
 
                 case MINING_NOTIFY:
                     GLOBAL_STATE->SYSTEM_MODULE.work_received++;
+                    stratum_api_v1_message.mining_notification->received_time_us = receive_time_us;
                     SYSTEM_notify_new_ntime(GLOBAL_STATE, stratum_api_v1_message.mining_notification->ntime);
                     if (stratum_api_v1_message.mining_notification->clean_jobs &&
                         (GLOBAL_STATE->stratum_queue.count > 0)) {
@@ -420,7 +433,7 @@ void stratum_v1_task(void *pvParameters)
                             if (stratum_api_v1_message.response_success) {
                                 ESP_LOGI(TAG, "message result accepted");
                                 ESP_LOGI(TAG, "Stratum response time: %.1f ms", response_time_ms);
-                                GLOBAL_STATE->SYSTEM_MODULE.response_time = response_time_ms;
+                                SYSTEM_notify_share_response(GLOBAL_STATE, response_time_ms);
                                 SYSTEM_notify_accepted_share(GLOBAL_STATE);
                             } else {
                                 ESP_LOGW(TAG, "message result rejected: %s", stratum_api_v1_message.error_str);
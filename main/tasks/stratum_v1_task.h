@@ -5,5 +5,7 @@
 
 void stratum_v1_task(void *pvParameters);
 void stratum_v1_close_connection(GlobalState *GLOBAL_STATE);
+// Sends mining.suggest_difficulty on the current connection
+int stratum_v1_suggest_difficulty(GlobalState *GLOBAL_STATE, uint32_t difficulty);
 
 #endif // STRATUM_V1_TASK_H_
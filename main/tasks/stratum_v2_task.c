@@ -117,48 +117,56 @@ static inline void stratum_v2_record_submit_time(uint32_t sequence_number)
     stratum_v2_submit_time_us[sequence_number % SV2_SUBMIT_TIMING_SLOTS] = esp_timer_get_time();
 }
 
-int stratum_v2_submit_share(GlobalState *GLOBAL_STATE, uint32_t job_id, uint32_t nonce,
-                            uint32_t ntime, uint32_t version)
+int stratum_v2_build_share_frame(GlobalState *GLOBAL_STATE, uint8_t *buf, size_t buf_len,
+                                 uint32_t job_id, uint32_t nonce, uint32_t ntime, uint32_t version,
+                                 const uint8_t *extranonce, uint8_t extranonce_len)
 {
-    if (!GLOBAL_STATE->transport || !GLOBAL_STATE->sv2_conn || !GLOBAL_STATE->sv2_noise_ctx) {
+    if (!GLOBAL_STATE->sv2_conn) {
         return -1;
     }
 
     sv2_conn_t *conn = GLOBAL_STATE->sv2_conn;
-    uint8_t buf[SV2_FRAME_HEADER_SIZE + 24];
-
     uint32_t sequence_number = conn->sequence_number++;
-    int len = sv2_build_submit_shares_standard(buf, sizeof(buf),
-                                                conn->channel_id,
-                                                sequence_number,
-                                                job_id, nonce, ntime, version);
+    int len;
+    if (conn->channel_type == SV2_CHANNEL_EXTENDED) {
+        // SV2 spec: extranonce_size is the miner's rollable portion.
+        // The pool prepends its extranonce_prefix separately.
+        len = sv2_build_submit_shares_extended(buf, buf_len,
+                                               conn->channel_id,
+                                               sequence_number,
+                                               job_id, nonce, ntime, version,
+                                               extranonce, extranonce_len);
+    } else {
+        len = sv2_build_submit_shares_standard(buf, buf_len,
+                                               conn->channel_id,
+                                               sequence_number,
+                                               job_id, nonce, ntime, version);
+    }
     if (len < 0) return -1;
 
     stratum_v2_record_submit_time(sequence_number);
-    return sv2_noise_send(GLOBAL_STATE->sv2_noise_ctx, GLOBAL_STATE->transport, buf, len);
+    return len;
 }
 
-int stratum_v2_submit_share_extended(GlobalState *GLOBAL_STATE, uint32_t job_id,
-                                     uint32_t nonce, uint32_t ntime, uint32_t version,
-                                     const uint8_t *extranonce, uint8_t extranonce_len)
+int stratum_v2_send_frames(GlobalState *GLOBAL_STATE, const uint8_t *frames, int frames_len)
 {
-    if (!GLOBAL_STATE->transport || !GLOBAL_STATE->sv2_conn || !GLOBAL_STATE->sv2_noise_ctx) {
+    if (!GLOBAL_STATE->transport || !GLOBAL_STATE->sv2_noise_ctx) {
         return -1;
     }
+    return sv2_noise_send_frames(GLOBAL_STATE->sv2_noise_ctx, GLOBAL_STATE->transport, frames, frames_len);
+}
 
+int stratum_v2_update_channel(GlobalState *GLOBAL_STATE, float nominal_hash_rate, const uint8_t max_target[32])
+{
     sv2_conn_t *conn = GLOBAL_STATE->sv2_conn;
-    uint8_t buf[SV2_FRAME_HEADER_SIZE + 24 + 1 + 32];
+    if (!conn || !conn->channel_opened) {
+        return -1;
+    }
 
-    uint32_t sequence_number = conn->sequence_number++;
-    int len = sv2_build_submit_shares_extended(buf, sizeof(buf),
-                                                conn->channel_id,
-                                                sequence_number,
-                                                job_id, nonce, ntime, version,
-                                                extranonce, extranonce_len);
+    uint8_t frame[SV2_FRAME_HEADER_SIZE + 40];
+    int len = sv2_build_update_channel(frame, sizeof(frame), conn->channel_id, nominal_hash_rate, max_target);
     if (len < 0) return -1;
-
-    stratum_v2_record_submit_time(sequence_number);
-    return sv2_noise_send(GLOBAL_STATE->sv2_noise_ctx, GLOBAL_STATE->transport, buf, len);
+    return stratum_v2_send_frames(GLOBAL_STATE, frame, len);
 }
 
 bool stratum_v2_is_extended_channel(GlobalState *GLOBAL_STATE)
@@ -679,6 +687,7 @@ void stratum_v2_task(void *pvParameters)
 
         GLOBAL_STATE->transport = transport;
         stratum_socket_set_options(transport);
+        SYSTEM_notify_pool_connected(GLOBAL_STATE, STRATUM_PROTOCOL_V2);
 
         // Reset connection state
         memset(conn, 0, sizeof(*conn));
@@ -956,7 +965,7 @@ void stratum_v2_task(void *pvParameters)
                         if (submit_time_us > 0) {
                             float response_time_ms = (float)(esp_timer_get_time() - submit_time_us) / 1000.0f;
                             ESP_LOGI(TAG, "Shares accepted: %lu (%.1f ms)", accepted_count, response_time_ms);
-                            GLOBAL_STATE->SYSTEM_MODULE.response_time = response_time_ms;
+                            SYSTEM_notify_share_response(GLOBAL_STATE, response_time_ms);
                             GLOBAL_STATE->SYSTEM_MODULE.response_share_batch = (uint16_t)accepted_count;
                             stratum_v2_submit_time_us[slot] = 0;
                         } else {
@@ -6,11 +6,15 @@
 
 void stratum_v2_task(void *pvParameters);
 void stratum_v2_close_connection(GlobalState *GLOBAL_STATE);
-int stratum_v2_submit_share(GlobalState *GLOBAL_STATE, uint32_t job_id, uint32_t nonce,
-                            uint32_t ntime, uint32_t version);
-int stratum_v2_submit_share_extended(GlobalState *GLOBAL_STATE, uint32_t job_id,
-                                     uint32_t nonce, uint32_t ntime, uint32_t version,
-                                     const uint8_t *extranonce, uint8_t extranonce_len);
+// Builds the SubmitShares frame (standard or extended, matching the open
+// channel) for one share into buf. Returns the frame length or -1.
+int stratum_v2_build_share_frame(GlobalState *GLOBAL_STATE, uint8_t *buf, size_t buf_len,
+                                 uint32_t job_id, uint32_t nonce, uint32_t ntime, uint32_t version,
+                                 const uint8_t *extranonce, uint8_t extranonce_len);
+// Encrypts and sends back-to-back frames in a single write
+int stratum_v2_send_frames(GlobalState *GLOBAL_STATE, const uint8_t *frames, int frames_len);
 bool stratum_v2_is_extended_channel(GlobalState *GLOBAL_STATE);
+// Sends UpdateChannel for the open channel (nominal_hash_rate in H/s)
+int stratum_v2_update_channel(GlobalState *GLOBAL_STATE, float nominal_hash_rate, const uint8_t max_target[32]);
 
 #endif // STRATUM_V2_TASK_H